@@ -1,20 +1,28 @@
 #include <iostream>
+#include <cstdio>
 #include <cstring>
 
 #include "params.h"
 #include "sequential/kmeans.h"
 #include "parallel/kmeans.h"
+#include "parallel/sparse_kmeans.h"
+#include "parallel/server.h"
+#include "parallel/streaming.h"
 
 
 std::string INIT_MODE = "";
 std::string FILE_PATH = "";
-static int NUM_POINTS = 0;
+static long long NUM_POINTS = 0;
 static int NUM_CLUSTERS = 0;
 static int DIMENSIONS = 0;
 static std::string EXECUTION_TYPE = "";
 static int NUM_THREADS = 0;
 static std::string BASE_PATH = ".\\results\\";
 static bool LOG = false;
+static bool WEIGHTED = false;
+static Parallel::Options OPTIONS;
+static std::string SERVER_SOCKET = "";
+static std::string STREAM_PATH = "";
 
 void printHelp() {
     std::cout << "K-Means-OpenMP Help:" << std::endl;
@@ -30,6 +38,44 @@ void printHelp() {
     std::cout << "  --num_threads, -T: Number of threads to use for parallel execution." << std::endl;
     std::cout << "  --base_path, -B: Base path for the results (default: './results/')." << std::endl;
     std::cout << "  --logs, -L: Enable logging of results (default: disabled)." << std::endl;
+    std::cout << "  --weighted, -W: The last column of the input file is the weight of the points (only with '--input_mode=input')." << std::endl;
+    std::cout << "  --sparse, -X: The input file has sparse points in libsvm/svmlight format ('<label> <index>:<value> ...'), clustered with dense centroids (only with '--input_mode=input' and '--execution_type=parallel')." << std::endl;
+    std::cout << "  --pipeline: Sample the initial centroids from the chunks of the input file while it is loaded, so that the first iteration starts as soon as the last chunk is parsed (only with '--input_mode=input' and '--execution_type=parallel')." << std::endl;
+    std::cout << "  --dedupe, -Q: Collapse the points with identical coordinates into weighted points (only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --reorder, -Z: Order of the points in memory ('input', or sorted by a 'morton' or 'hilbert' space-filling curve key for locality, default: 'input', only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --metric, -M: Distance metric ('euclidean', 'cosine' for spherical k-means on the normalized points, or 'manhattan' with a median update, default: 'euclidean', only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --precision, -Y: Precision of the stored coordinates of the points in the iterations ('double', 'bf16', 'fp16' or 'int8', default: 'double'), reporting the inertia deviation against the double precision engine (only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --coreset, -O: Number of points of a lightweight coreset to cluster instead of all the points (only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --coreset_assign: Assign all the points to the centroids found on the coreset." << std::endl;
+    std::cout << "  --coreset_compare: Compare the coreset clustering with the full Lloyd on the same points (time saved and inertia gap)." << std::endl;
+    std::cout << "  --bisecting, -H: Find the clusters by bisecting k-means in O(N log K), optionally with the criterion 'largest' or 'sse' (e.g. '--bisecting=largest', default: 'sse') (only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --refine: Refine the bisecting clusters with the flat iterations." << std::endl;
+    std::cout << "  --engine, -G: Assignment kernel ('naive', 'tiled' or the approximate 'ivf' and 'projected', default: 'naive', only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --lists: Number of lists of the centroid index of the 'ivf' engine (default: square root of the number of clusters)." << std::endl;
+    std::cout << "  --nprobe, -V: Number of lists scanned for each point by the 'ivf' engine, trading recall for speed (default: " << IVF_NPROBE << ")." << std::endl;
+    std::cout << "  --sketch: Number of dimensions of the random-projection sketch of the 'projected' engine (default: " << SKETCH_DIMENSIONS << ", at most " << MAX_SKETCH_DIMENSIONS << ")." << std::endl;
+    std::cout << "  --shortlist: Number of centroids shortlisted in the sketch and re-ranked with the exact distances by the 'projected' engine (default: " << SHORTLIST << ")." << std::endl;
+    std::cout << "  --recall_audit: Measure the recall and the inertia penalty of the 'ivf' engine against the exact assignment on a sample of points." << std::endl;
+    std::cout << "  --autotune, -A: Tune the engine, tile sizes and number of threads for the workload (only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --tuning_cache, -C: Path of the tuning cache file (default: '" << TUNING_CACHE << "')." << std::endl;
+    std::cout << "  --schedule, -S: Scheduling of the assignment phase ('static' or 'stealing', default: 'stealing', only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --reduction, -U: Reduction of the partial sums ('deterministic' or 'threads', default: 'threads', only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --trace, -R: Prefix of the JSON-lines metrics log and Chrome trace files to write (only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --evaluate: Evaluate the quality of the clustering (Davies-Bouldin, Calinski-Harabasz and silhouette, estimated on a stratified sample with confidence bounds above " << SILHOUETTE_EXACT << " points, only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --profile, -P: Profile the phases of each iteration with hardware counters (only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --multires: Converge on uniform subsamples of growing size (from the given fraction of the points, by a factor " << MULTIRES_FACTOR << ", default: " << MULTIRES_FRACTION << ") before iterating on all the points (only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --k_range: Range of the number of clusters 'a:b[:step]' to sweep on the same points as a warm-started chain, reporting the inertia and the Calinski-Harabasz score of each K (replaces '--num_clusters', only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --checkpoint: Path of a binary checkpoint file of the centroids and the state of the iterations, written periodically (only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --checkpoint_interval: Number of iterations between two checkpoints (default: " << CHECKPOINT_INTERVAL << ")." << std::endl;
+    std::cout << "  --resume: Resume the iterations from the '--checkpoint' file if it exists (starting from the initial centroids otherwise)." << std::endl;
+    std::cout << "  --init_centroids: Path of a file of centroids of a previous model to warm-start from ('--output' format, binary if the extension is '.bin', only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --output: Prefix of the files of the final labels ('<prefix>.labels.<csv|bin>') and centroids ('<prefix>.centroids.<csv|bin>') to write (only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --output_format: Format of the output files ('csv' or 'binary', default: 'csv')." << std::endl;
+    std::cout << "  --stream: Path of a stream of points to cluster online ('-' for stdin, or a named pipe), updating the centroids point by point from the first K points, with the '--num_clusters', '--dimensions' and '--num_threads' worker threads (only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --decay: Decay of the weights of the centroids for each point of the stream, so that the centroids follow a drifting stream (default: " << STREAM_DECAY << " for the plain sequential k-means)." << std::endl;
+    std::cout << "  --snapshot_interval: Number of seconds between two snapshots of the centroids of the stream, written to '<output>.centroids.<csv|bin>' (default: " << SNAPSHOT_INTERVAL << ")." << std::endl;
+    std::cout << "  --server: Path of a Unix domain socket to serve clustering jobs on, with a dataset cache and a budget of '--num_threads' threads (only with '--execution_type=parallel')." << std::endl;
+    std::cout << "  --client: Path of the Unix domain socket of a server to submit the job of the other options to (only with '--input_mode=input' and '--execution_type=parallel')." << std::endl;
 }
 
 int processInput(int argc, const char *argv[]) {
@@ -57,7 +103,7 @@ int processInput(int argc, const char *argv[]) {
             }
         } else if ((INIT_MODE == "random") && (strncmp(arg, "--num_points=", 13) == 0 || strncmp(arg, "-N=", 3)) == 0) {
             // Set the number of points.
-            NUM_POINTS = atoi(strchr(arg, '=') + 1);
+            NUM_POINTS = atoll(strchr(arg, '=') + 1);
         } else if ((INIT_MODE == "input") && (strncmp(arg, "--file_path=", 12) == 0 || strncmp(arg, "-F=", 3)) == 0) {
             // Set the input file path.
             FILE_PATH = strchr(arg, '=') + 1;
@@ -97,12 +143,276 @@ int processInput(int argc, const char *argv[]) {
         } else if (strcmp(arg, "--logs") == 0 || strcmp(arg, "-L") == 0) {
             // Enable logging of results.
             LOG = true;
+        } else if ((EXECUTION_TYPE == "parallel") && strcmp(arg, "--evaluate") == 0) {
+            // Enable the evaluation of the quality of the clustering.
+            OPTIONS.evaluate = true;
+        } else if ((EXECUTION_TYPE == "parallel") && (strcmp(arg, "--profile") == 0 || strcmp(arg, "-P") == 0)) {
+            // Enable profiling of the iteration phases.
+            OPTIONS.profile = true;
+        } else if ((INIT_MODE == "input" || STREAM_PATH != "") && (strcmp(arg, "--weighted") == 0 || strcmp(arg, "-W") == 0)) {
+            // Read the weights of the points from the last column of the input file.
+            WEIGHTED = true;
+            OPTIONS.weighted = true;
+        } else if ((INIT_MODE == "input") && (EXECUTION_TYPE == "parallel") && (strcmp(arg, "--sparse") == 0 || strcmp(arg, "-X") == 0)) {
+            // Set the sparse input format.
+            OPTIONS.sparse = true;
+        } else if ((INIT_MODE == "input") && (EXECUTION_TYPE == "parallel") && strcmp(arg, "--pipeline") == 0) {
+            // Pipeline the seeding with the loading of the points.
+            OPTIONS.pipeline = true;
+        } else if ((EXECUTION_TYPE == "parallel") && (strcmp(arg, "--dedupe") == 0 || strcmp(arg, "-Q") == 0)) {
+            // Enable the deduplication of the points.
+            OPTIONS.dedupe = true;
+        } else if ((EXECUTION_TYPE == "parallel") && (strncmp(arg, "--reorder=", 10) == 0 || strncmp(arg, "-Z=", 3) == 0)) {
+            // Set the order of the points in memory.
+            const char *value = strchr(arg, '=') + 1;
+
+            if (strcmp(value, "input") == 0) {
+                OPTIONS.order = Parallel::INPUT_ORDER;
+            } else if (strcmp(value, "morton") == 0) {
+                OPTIONS.order = Parallel::MORTON;
+            } else if (strcmp(value, "hilbert") == 0) {
+                OPTIONS.order = Parallel::HILBERT;
+            } else {
+                // Invalid order.
+                std::cout << "Invalid argument for reorder. Please use either 'input', 'morton' or 'hilbert'." << std::endl;
+                return 1;
+            }
+        } else if ((EXECUTION_TYPE == "parallel") && (strncmp(arg, "--metric=", 9) == 0 || strncmp(arg, "-M=", 3) == 0)) {
+            // Set the distance metric.
+            const char *value = strchr(arg, '=') + 1;
+
+            if (strcmp(value, "euclidean") == 0) {
+                OPTIONS.metric = Parallel::EUCLIDEAN;
+            } else if (strcmp(value, "cosine") == 0) {
+                OPTIONS.metric = Parallel::COSINE;
+            } else if (strcmp(value, "manhattan") == 0) {
+                OPTIONS.metric = Parallel::MANHATTAN;
+            } else {
+                // Invalid metric.
+                std::cout << "Invalid argument for metric. Please use either 'euclidean', 'cosine' or 'manhattan'." << std::endl;
+                return 1;
+            }
+        } else if ((EXECUTION_TYPE == "parallel") && (strncmp(arg, "--precision=", 12) == 0 || strncmp(arg, "-Y=", 3) == 0)) {
+            // Set the precision of the stored coordinates.
+            const char *value = strchr(arg, '=') + 1;
+
+            if (strcmp(value, "double") == 0) {
+                OPTIONS.precision = Parallel::DOUBLE;
+            } else if (strcmp(value, "bf16") == 0) {
+                OPTIONS.precision = Parallel::BF16;
+            } else if (strcmp(value, "fp16") == 0) {
+                OPTIONS.precision = Parallel::FP16;
+            } else if (strcmp(value, "int8") == 0) {
+                OPTIONS.precision = Parallel::INT8;
+            } else {
+                // Invalid precision.
+                std::cout << "Invalid argument for precision. Please use either 'double', 'bf16', 'fp16' or 'int8'." << std::endl;
+                return 1;
+            }
+        } else if ((EXECUTION_TYPE == "parallel") && (strncmp(arg, "--coreset=", 10) == 0 || strncmp(arg, "-O=", 3) == 0)) {
+            // Set the number of points of the coreset.
+            OPTIONS.coresetSize = atoi(strchr(arg, '=') + 1);
+        } else if ((EXECUTION_TYPE == "parallel") && strcmp(arg, "--coreset_assign") == 0) {
+            // Enable the assignment pass over all the points after the coreset clustering.
+            OPTIONS.coresetAssign = true;
+        } else if ((EXECUTION_TYPE == "parallel") && strcmp(arg, "--coreset_compare") == 0) {
+            // Enable the comparison of the coreset clustering with the full Lloyd.
+            OPTIONS.coresetCompare = true;
+        } else if ((EXECUTION_TYPE == "parallel") && (strcmp(arg, "--bisecting") == 0 || strcmp(arg, "-H") == 0 || strncmp(arg, "--bisecting=", 12) == 0 || strncmp(arg, "-H=", 3) == 0)) {
+            // Enable the bisecting engine (with the optional criterion).
+            OPTIONS.bisecting = true;
+            const char *value = strchr(arg, '=');
+
+            if (value == nullptr || strcmp(value + 1, "sse") == 0) {
+                OPTIONS.bisection = Parallel::HIGHEST_SSE;
+            } else if (strcmp(value + 1, "largest") == 0) {
+                OPTIONS.bisection = Parallel::LARGEST;
+            } else {
+                // Invalid bisecting criterion.
+                std::cout << "Invalid argument for bisecting. Please use either 'largest' or 'sse'." << std::endl;
+                return 1;
+            }
+        } else if ((EXECUTION_TYPE == "parallel") && strcmp(arg, "--refine") == 0) {
+            // Enable the refinement of the bisecting clusters.
+            OPTIONS.refine = true;
+        } else if ((EXECUTION_TYPE == "parallel") && (strncmp(arg, "--engine=", 9) == 0 || strncmp(arg, "-G=", 3) == 0)) {
+            // Set the assignment kernel.
+            const char *value = strchr(arg, '=') + 1;
+
+            if (strcmp(value, "naive") == 0) {
+                OPTIONS.kernel.engine = Parallel::NAIVE;
+            } else if (strcmp(value, "tiled") == 0) {
+                OPTIONS.kernel.engine = Parallel::TILED;
+            } else if (strcmp(value, "ivf") == 0) {
+                OPTIONS.kernel.engine = Parallel::IVF;
+            } else if (strcmp(value, "projected") == 0) {
+                OPTIONS.kernel.engine = Parallel::PROJECTED;
+            } else {
+                // Invalid engine.
+                std::cout << "Invalid argument for engine. Please use either 'naive', 'tiled', 'ivf' or 'projected'." << std::endl;
+                return 1;
+            }
+        } else if ((EXECUTION_TYPE == "parallel") && strncmp(arg, "--lists=", 8) == 0) {
+            // Set the number of lists of the centroid index.
+            OPTIONS.lists = atoi(strchr(arg, '=') + 1);
+        } else if ((EXECUTION_TYPE == "parallel") && (strncmp(arg, "--nprobe=", 9) == 0 || strncmp(arg, "-V=", 3) == 0)) {
+            // Set the number of lists scanned by a query of the centroid index.
+            OPTIONS.nprobe = atoi(strchr(arg, '=') + 1);
+        } else if ((EXECUTION_TYPE == "parallel") && strncmp(arg, "--sketch=", 9) == 0) {
+            // Set the number of dimensions of the random-projection sketch.
+            OPTIONS.sketchDimensions = atoi(strchr(arg, '=') + 1);
+        } else if ((EXECUTION_TYPE == "parallel") && strncmp(arg, "--shortlist=", 12) == 0) {
+            // Set the number of centroids shortlisted in the sketch.
+            OPTIONS.shortlist = atoi(strchr(arg, '=') + 1);
+        } else if ((EXECUTION_TYPE == "parallel") && strcmp(arg, "--recall_audit") == 0) {
+            // Enable the recall audit of the approximate assignment.
+            OPTIONS.recallAudit = true;
+        } else if ((EXECUTION_TYPE == "parallel") && (strcmp(arg, "--autotune") == 0 || strcmp(arg, "-A") == 0)) {
+            // Enable the autotuning of the assignment kernel.
+            OPTIONS.autotune = true;
+        } else if ((EXECUTION_TYPE == "parallel") && (strncmp(arg, "--tuning_cache=", 15) == 0 || strncmp(arg, "-C=", 3) == 0)) {
+            // Set the path of the tuning cache file.
+            OPTIONS.tuningCache = strchr(arg, '=') + 1;
+        } else if ((EXECUTION_TYPE == "parallel") && (strncmp(arg, "--schedule=", 11) == 0 || strncmp(arg, "-S=", 3) == 0)) {
+            // Set the scheduling of the assignment phase.
+            const char *value = strchr(arg, '=') + 1;
+
+            if (strcmp(value, "static") == 0) {
+                OPTIONS.schedule = Parallel::STATIC;
+            } else if (strcmp(value, "stealing") == 0) {
+                OPTIONS.schedule = Parallel::STEALING;
+            } else {
+                // Invalid schedule.
+                std::cout << "Invalid argument for schedule. Please use either 'static' or 'stealing'." << std::endl;
+                return 1;
+            }
+        } else if ((EXECUTION_TYPE == "parallel") && (strncmp(arg, "--reduction=", 12) == 0 || strncmp(arg, "-U=", 3) == 0)) {
+            // Set the reduction of the partial sums.
+            const char *value = strchr(arg, '=') + 1;
+
+            if (strcmp(value, "deterministic") == 0) {
+                OPTIONS.reduction = Parallel::DETERMINISTIC;
+            } else if (strcmp(value, "threads") == 0) {
+                OPTIONS.reduction = Parallel::THREADS;
+            } else {
+                // Invalid reduction.
+                std::cout << "Invalid argument for reduction. Please use either 'deterministic' or 'threads'." << std::endl;
+                return 1;
+            }
+        } else if ((EXECUTION_TYPE == "parallel") && (strncmp(arg, "--trace=", 8) == 0 || strncmp(arg, "-R=", 3) == 0)) {
+            // Set the prefix of the trace files.
+            OPTIONS.trace = strchr(arg, '=') + 1;
+        } else if ((EXECUTION_TYPE == "parallel") && (strcmp(arg, "--multires") == 0 || strncmp(arg, "--multires=", 11) == 0)) {
+            // Enable the multi-resolution solve (with the fraction of the first stage, if given).
+            OPTIONS.multiresFraction = strchr(arg, '=') != nullptr ? atof(strchr(arg, '=') + 1) : MULTIRES_FRACTION;
+
+            if (OPTIONS.multiresFraction <= 0 || OPTIONS.multiresFraction >= 1) {
+                // Invalid fraction.
+                std::cout << "Invalid argument for multires. Please use a fraction of the points between 0 and 1 (e.g. '--multires=0.01')." << std::endl;
+                return 1;
+            }
+        } else if ((EXECUTION_TYPE == "parallel") && strncmp(arg, "--k_range=", 10) == 0) {
+            // Set the range of the number of clusters of the K sweep.
+            int minK = 0, maxK = 0, step = 1;
+
+            if (sscanf(strchr(arg, '=') + 1, "%d:%d:%d", &minK, &maxK, &step) < 2 || minK < 1 || maxK <= minK || step < 1) {
+                // Invalid range.
+                std::cout << "Invalid argument for K range. Please use 'a:b' or 'a:b:step' with 1 <= a < b and step >= 1." << std::endl;
+                return 1;
+            }
+
+            NUM_CLUSTERS = minK;
+            OPTIONS.sweepMaxK = maxK;
+            OPTIONS.sweepStep = step;
+        } else if ((EXECUTION_TYPE == "parallel") && strncmp(arg, "--checkpoint=", 13) == 0) {
+            // Set the path of the checkpoint file.
+            OPTIONS.checkpoint = strchr(arg, '=') + 1;
+        } else if ((EXECUTION_TYPE == "parallel") && strncmp(arg, "--checkpoint_interval=", 22) == 0) {
+            // Set the number of iterations between two checkpoints.
+            OPTIONS.checkpointInterval = atoi(strchr(arg, '=') + 1);
+
+            if (OPTIONS.checkpointInterval < 1) {
+                // Invalid checkpoint interval.
+                std::cout << "Invalid argument for checkpoint interval. Please use a positive number of iterations." << std::endl;
+                return 1;
+            }
+        } else if ((EXECUTION_TYPE == "parallel") && strcmp(arg, "--resume") == 0) {
+            // Resume the iterations from the checkpoint.
+            OPTIONS.resume = true;
+        } else if ((EXECUTION_TYPE == "parallel") && strncmp(arg, "--init_centroids=", 17) == 0) {
+            // Set the path of the file of the initial centroids.
+            OPTIONS.initCentroids = strchr(arg, '=') + 1;
+        } else if ((EXECUTION_TYPE == "parallel") && strncmp(arg, "--output=", 9) == 0) {
+            // Set the prefix of the output files.
+            OPTIONS.output = strchr(arg, '=') + 1;
+        } else if ((EXECUTION_TYPE == "parallel") && strncmp(arg, "--output_format=", 16) == 0) {
+            // Set the format of the output files.
+            const char *value = strchr(arg, '=') + 1;
+
+            if (strcmp(value, "csv") == 0) {
+                OPTIONS.outputFormat = Parallel::CSV_OUTPUT;
+            } else if (strcmp(value, "binary") == 0) {
+                OPTIONS.outputFormat = Parallel::BINARY_OUTPUT;
+            } else {
+                // Invalid output format.
+                std::cout << "Invalid argument for output format. Please use either 'csv' or 'binary'." << std::endl;
+                return 1;
+            }
+        } else if ((EXECUTION_TYPE == "parallel") && strncmp(arg, "--stream=", 9) == 0) {
+            // Set the path of the stream of points.
+            STREAM_PATH = strchr(arg, '=') + 1;
+        } else if ((EXECUTION_TYPE == "parallel") && strncmp(arg, "--decay=", 8) == 0) {
+            // Set the decay of the weights of the centroids of the stream.
+            OPTIONS.streamDecay = atof(strchr(arg, '=') + 1);
+
+            if (OPTIONS.streamDecay <= 0 || OPTIONS.streamDecay > 1) {
+                // Invalid decay.
+                std::cout << "Invalid argument for decay. Please use a decay between 0 (excluded) and 1 (e.g. '--decay=0.999')." << std::endl;
+                return 1;
+            }
+        } else if ((EXECUTION_TYPE == "parallel") && strncmp(arg, "--snapshot_interval=", 20) == 0) {
+            // Set the number of seconds between two snapshots of the stream.
+            OPTIONS.snapshotInterval = atof(strchr(arg, '=') + 1);
+
+            if (OPTIONS.snapshotInterval <= 0) {
+                // Invalid snapshot interval.
+                std::cout << "Invalid argument for snapshot interval. Please use a positive number of seconds." << std::endl;
+                return 1;
+            }
+        } else if ((EXECUTION_TYPE == "parallel") && strncmp(arg, "--server=", 9) == 0) {
+            // Set the socket of the server.
+            SERVER_SOCKET = strchr(arg, '=') + 1;
         } else {
             std::cout << "Invalid argument: " << arg << ". Use '--help' or '-h' for usage instructions." << std::endl;
             return 1;
         }
     }
 
+    if (OPTIONS.resume && OPTIONS.checkpoint == "") {
+        std::cout << "Please specify the checkpoint file to resume from with '--checkpoint'." << std::endl;
+        return 1;
+    }
+
+    if (SERVER_SOCKET != "") {
+        // The parameters of the data are given by the jobs.
+        if (NUM_THREADS < 1) {
+            std::cout << "Please specify valid values for required parameters." << std::endl;
+            return 1;
+        }
+
+        return 0;
+    }
+
+    if (STREAM_PATH != "") {
+        // The points are read from the stream.
+        if (NUM_CLUSTERS < 1 || DIMENSIONS < 1 || NUM_THREADS < 1) {
+            std::cout << "Please specify valid values for required parameters." << std::endl;
+            return 1;
+        }
+
+        return 0;
+    }
+
     if (INIT_MODE == "" || (INIT_MODE == "random" && NUM_POINTS < 1) || (INIT_MODE == "input" && FILE_PATH == "") || NUM_CLUSTERS < 1 || DIMENSIONS < 1 || EXECUTION_TYPE == "" || (EXECUTION_TYPE == "parallel" && NUM_THREADS < 1)) {
         std::cout << "Please specify valid values for required parameters." << std::endl;
         return 1;
@@ -111,7 +421,60 @@ int processInput(int argc, const char *argv[]) {
     return 0;
 }
 
+/*
+    * Parses the command-line arguments of a job submitted to the server.
+    *
+    * @param arguments: Command-line arguments of the job.
+    * @param job: The job (filled by the function).
+    *
+    * @returns (bool) True if the arguments are a valid clustering job of an input file.
+*/
+bool parseJob(const std::vector<std::string>& arguments, Parallel::Job& job) {
+    // Reset the parameters of the previous job.
+    INIT_MODE = "";
+    FILE_PATH = "";
+    NUM_POINTS = 0;
+    NUM_CLUSTERS = 0;
+    DIMENSIONS = 0;
+    EXECUTION_TYPE = "";
+    NUM_THREADS = 0;
+    WEIGHTED = false;
+    OPTIONS = Parallel::Options();
+    SERVER_SOCKET = "";
+    STREAM_PATH = "";
+
+    std::vector<const char*> argv = {"kmean"};
+    for (const std::string& argument : arguments) {
+        argv.push_back(argument.c_str());
+    }
+
+    if (processInput(argv.size(), argv.data()) != 0 || INIT_MODE != "input" || EXECUTION_TYPE != "parallel" || OPTIONS.sparse || SERVER_SOCKET != "" || STREAM_PATH != "") {
+        return false;
+    }
+
+    job.filePath = FILE_PATH;
+    job.K = NUM_CLUSTERS;
+    job.threads = NUM_THREADS;
+    job.options = OPTIONS;
+
+    return true;
+}
+
 int main(int argc, const char *argv[]) {
+    // Submit the job to a server.
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--client=", 9) == 0) {
+            std::vector<std::string> arguments;
+            for (int j = 1; j < argc; ++j) {
+                if (j != i) {
+                    arguments.push_back(argv[j]);
+                }
+            }
+
+            return Parallel::submit(strchr(argv[i], '=') + 1, arguments);
+        }
+    }
+
     // Process the input.
     if (processInput(argc, argv) != 0) {
         return 1;
@@ -119,17 +482,24 @@ int main(int argc, const char *argv[]) {
 
 
     // Run the algorithm.
-    if (EXECUTION_TYPE == "sequential") {
+    if (SERVER_SOCKET != "") {
+        const std::string socketPath = SERVER_SOCKET;
+        Parallel::Server(socketPath, NUM_THREADS, parseJob).serve();
+    } else if (STREAM_PATH != "") {
+        Parallel::StreamingKMeans(STREAM_PATH, NUM_CLUSTERS, DIMENSIONS, NUM_THREADS, OPTIONS).run();
+    } else if (EXECUTION_TYPE == "sequential") {
         if (INIT_MODE == "random") {
             Sequential::KMeans(NUM_POINTS, NUM_CLUSTERS, DIMENSIONS).run(BASE_PATH, LOG);
         } else {
-            Sequential::KMeans(FILE_PATH, NUM_CLUSTERS).run(BASE_PATH, LOG);
+            Sequential::KMeans(FILE_PATH, NUM_CLUSTERS, WEIGHTED).run(BASE_PATH, LOG);
         }
     } else {
         if (INIT_MODE == "random") {
-            Parallel::KMeans(NUM_POINTS, NUM_CLUSTERS, DIMENSIONS, NUM_THREADS).run(BASE_PATH, LOG);
+            Parallel::KMeans(NUM_POINTS, NUM_CLUSTERS, DIMENSIONS, NUM_THREADS, OPTIONS).run(BASE_PATH, LOG);
+        } else if (OPTIONS.sparse) {
+            Parallel::SparseKMeans(FILE_PATH, NUM_CLUSTERS, NUM_THREADS, OPTIONS).run(BASE_PATH, LOG);
         } else {
-            Parallel::KMeans(FILE_PATH, NUM_CLUSTERS, NUM_THREADS).run(BASE_PATH, LOG);
+            Parallel::KMeans(FILE_PATH, NUM_CLUSTERS, NUM_THREADS, OPTIONS).run(BASE_PATH, LOG);
         }
     }
 
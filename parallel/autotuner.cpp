@@ -0,0 +1,210 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <float.h>
+#include <omp.h>
+
+#include "autotuner.h"
+#include "kmeans.h"
+#include "../params.h"
+
+
+namespace Parallel {
+    Autotuner::Autotuner(const std::string& path) : cachePath(path) { }
+
+
+    KernelConfig Autotuner::tune(KMeans& kmeans) {
+        const std::string cacheKey = key(kmeans.N, kmeans.K, kmeans.dimensions, kmeans.threads, kmeans.options);
+
+        // Use the cached configuration if available.
+        KernelConfig best;
+        if (load(cacheKey, kmeans.threads, best)) {
+            std::cout << "Autotune: using cached configuration (engine=" << ENGINE_NAMES[best.engine] << ", point_tile=" << best.pointTile << ", centroid_tile=" << best.centroidTile << ", threads=" << best.threads << ")." << std::endl;
+            return best;
+        }
+
+        const double startTime = omp_get_wtime();
+
+        // Sample the points for the probe iterations.
+        const long long N = kmeans.N;
+        const int K = kmeans.K, dimensions = kmeans.dimensions;
+        const int sampleSize = (int) std::min(N, (long long) AUTOTUNE_SAMPLE);
+
+        // Floyd's algorithm: sampleSize distinct indices in O(sampleSize), sorted for the locality of the copy.
+        std::default_random_engine generator(SEED); // Random number engine (with seed for reproducibility).
+        std::unordered_set<long long> drawn;
+        drawn.reserve(sampleSize);
+        for(long long j = N - sampleSize; j < N; j++) {
+            std::uniform_int_distribution<long long> intDistribution(0, j);
+            const long long t = intDistribution(generator);
+            drawn.insert(drawn.count(t) ? j : t);
+        }
+        std::vector<long long> indices(drawn.begin(), drawn.end());
+        std::sort(indices.begin(), indices.end());
+
+        Points sample(sampleSize, dimensions, new double[sampleSize * dimensions], new long long[sampleSize], new int[sampleSize], new double[sampleSize]);
+        #pragma omp parallel for schedule(static)
+        for(int s = 0; s < sampleSize; s++) {
+            for(int dim = 0; dim < dimensions; dim++) {
+                sample.coordinates[s + sampleSize * dim] = kmeans.points.coordinates[indices[s] + N * dim];
+            }
+            sample.pointsIds[s] = s;
+            sample.clustersIds[s] = -1;
+            sample.weights[s] = kmeans.points.weights[indices[s]];
+        }
+
+        // Probe the kernel of the execution (metric, precision and reduction), without the instrumentation and the outputs.
+        Options probeOptions = kmeans.nestedOptions();
+        probeOptions.precision = kmeans.options.precision;
+        KMeans probe(std::move(sample), kmeans.centroids.copy(), kmeans.threads, probeOptions);
+        if (probeOptions.precision != DOUBLE) {
+            probe.quantized = quantize(probe.points, probeOptions.precision, kmeans.threads);
+        }
+
+        // Candidate tile sizes.
+        const int pointTiles[] = {16, 32, 64, 128, 256};
+        const int centroidTiles[] = {4, 8, 16, 32};
+
+        // Probe the exact kernels with all the threads (the approximate engines trade accuracy and are only used on request).
+        double bestTime = DBL_MAX;
+        for(int engine = 0; engine < IVF; engine++) {
+            for(int pointTile : pointTiles) {
+                for(int centroidTile : centroidTiles) {
+                    // The centroid tile is not used by the naive engine.
+                    if ((engine == NAIVE && centroidTile != centroidTiles[0]) || (centroidTile > K && centroidTile != centroidTiles[0])) {
+                        continue;
+                    }
+
+                    KernelConfig config;
+                    config.engine = static_cast<Engine>(engine);
+                    config.pointTile = pointTile;
+                    config.centroidTile = centroidTile;
+                    config.threads = kmeans.threads;
+
+                    const double time = measure(probe, kmeans.centroids.coordinates, config);
+                    if (time < bestTime) {
+                        bestTime = time;
+                        best = config;
+                    }
+                }
+            }
+        }
+
+        // Probe the number of threads (powers of two) with the fastest kernel.
+        for(int threads = kmeans.threads / 2; threads >= 1; threads /= 2) {
+            KernelConfig config = best;
+            config.threads = threads;
+
+            const double time = measure(probe, kmeans.centroids.coordinates, config);
+            if (time < bestTime) {
+                bestTime = time;
+                best = config;
+            }
+        }
+
+        // Restore the number of threads of the execution.
+        omp_set_num_threads(kmeans.threads);
+
+        std::cout << "Autotune: probed " << sampleSize << " points in " << omp_get_wtime() - startTime << " seconds, selected engine=" << ENGINE_NAMES[best.engine] << ", point_tile=" << best.pointTile << ", centroid_tile=" << best.centroidTile << ", threads=" << best.threads << "." << std::endl;
+
+        store(cacheKey, best);
+
+        return best;
+    }
+
+
+    std::string Autotuner::cpuModel() {
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+
+        while (std::getline(cpuinfo, line)) {
+            if (line.compare(0, 10, "model name") == 0) {
+                // Skip the separator and the spaces.
+                size_t position = line.find(':');
+                if (position != std::string::npos) {
+                    return line.substr(line.find_first_not_of(" \t", position + 1));
+                }
+            }
+        }
+
+        return "unknown";
+    }
+
+    std::string Autotuner::key(const long long N, const int K, const int dimensions, const int threads, const Options& options) {
+        std::stringstream ss;
+        ss << cpuModel() << "|N=2^" << (int) ceil(log2(N)) << "|K=2^" << (int) ceil(log2(K)) << "|D=2^" << (int) ceil(log2(dimensions)) << "|T=" << threads;
+        ss << "|" << METRIC_NAMES[options.metric] << "|" << PRECISION_NAMES[options.precision] << "|" << (options.reduction == DETERMINISTIC ? "deterministic" : "threads");
+        return ss.str();
+    }
+
+
+    bool Autotuner::load(const std::string& cacheKey, const int maxThreads, KernelConfig& config) const {
+        std::ifstream file(cachePath);
+        std::string line;
+
+        // The last valid entry of a key is the most recent one (the invalid entries are skipped).
+        bool found = false;
+        while (std::getline(file, line)) {
+            size_t separator = line.find('\t');
+            if (separator == std::string::npos || line.substr(0, separator) != cacheKey) {
+                continue;
+            }
+
+            std::stringstream ss(line.substr(separator + 1));
+            std::string engine;
+            KernelConfig entry;
+            if (ss >> engine >> entry.pointTile >> entry.centroidTile >> entry.threads && entry.pointTile >= 1 && entry.pointTile <= MAX_POINT_TILE && entry.centroidTile >= 1 && entry.centroidTile <= MAX_CENTROID_TILE && entry.threads >= 1 && entry.threads <= maxThreads) {
+                for(int e = 0; e < NUM_ENGINES; e++) {
+                    if (engine == ENGINE_NAMES[e] && (e == NAIVE || e == TILED)) {
+                        entry.engine = static_cast<Engine>(e);
+                        config = entry;
+                        found = true;
+                    }
+                }
+            }
+        }
+
+        return found;
+    }
+
+    void Autotuner::store(const std::string& cacheKey, const KernelConfig& config) const {
+        std::ofstream file(cachePath, std::ios_base::app);
+
+        if (!file.is_open()) {
+            std::cout << "Autotune: couldn't write tuning cache '" << cachePath << "'." << std::endl;
+            return;
+        }
+
+        file << cacheKey << "\t" << ENGINE_NAMES[config.engine] << " " << config.pointTile << " " << config.centroidTile << " " << config.threads << std::endl;
+    }
+
+
+    double Autotuner::measure(KMeans& probe, const double* initialCoordinates, const KernelConfig& config) {
+        probe.kernel = config;
+        omp_set_num_threads(config.threads);
+
+        double minTime = DBL_MAX;
+        for(int r = 0; r <= AUTOTUNE_REPETITIONS; r++) {
+            // Restore the centroids so that every candidate runs the same iteration.
+            std::copy(initialCoordinates, initialCoordinates + probe.K * probe.dimensions, probe.centroids.coordinates);
+
+            double startTime = omp_get_wtime();
+            IterationMetrics metrics;
+            probe.KMeansIteration(metrics);
+            double time = omp_get_wtime() - startTime;
+
+            // The first iteration warms up the caches and the threads.
+            if (r > 0) {
+                minTime = std::min(minTime, time);
+            }
+        }
+
+        return minTime;
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef K_MEANS_PARALLEL_AUTOTUNER_H
+#define K_MEANS_PARALLEL_AUTOTUNER_H
+
+#include <string>
+
+#include "options.h"
+
+
+namespace Parallel {
+  class KMeans;
+
+  // Autotuner of the assignment kernel configuration for a workload (N, K, dimensions) and machine.
+  class Autotuner {
+    public:
+      /*
+        * Autotuner constructor.
+        *
+        * @param cachePath: Path of the tuning cache file.
+      */
+      Autotuner(const std::string& cachePath);
+
+
+      /*
+        * Tunes the kernel configuration of a k-means instance, probing short iterations on a sample of its points unless the configuration is cached.
+        *
+        * @param kmeans: The k-means instance.
+        *
+        * @returns (KernelConfig) The fastest kernel configuration.
+      */
+      KernelConfig tune(KMeans& kmeans);
+
+    private:
+      const std::string cachePath; // Path of the tuning cache file.
+
+
+      /*
+        * Gets the model of the CPU.
+        *
+        * @returns (std::string) The model of the CPU (or 'unknown' if not available).
+      */
+      static std::string cpuModel();
+
+      /*
+        * Gets the cache key of a workload, made of the CPU model, the shape bucket (powers of two of the sizes) and the kernel (metric, precision and reduction).
+        *
+        * @param N: Number of points.
+        * @param K: Number of clusters.
+        * @param dimensions: Number of dimensions.
+        * @param threads: Number of threads.
+        * @param options: Optional settings of the execution.
+        *
+        * @returns (std::string) The cache key.
+      */
+      static std::string key(const long long N, const int K, const int dimensions, const int threads, const Options& options);
+
+
+      /*
+        * Loads a configuration from the tuning cache (skipping the entries with an engine that is not tuned, tiles out of the limits or too many threads).
+        *
+        * @param key: The cache key.
+        * @param maxThreads: Maximum number of threads of the configuration.
+        * @param config: The loaded configuration.
+        *
+        * @returns (bool) True if the configuration is cached, false otherwise.
+      */
+      bool load(const std::string& key, const int maxThreads, KernelConfig& config) const;
+
+      /*
+        * Stores a configuration in the tuning cache.
+        *
+        * @param key: The cache key.
+        * @param config: The configuration.
+      */
+      void store(const std::string& key, const KernelConfig& config) const;
+
+
+      /*
+        * Measures the time of a probe iteration with a configuration.
+        *
+        * @param probe: The k-means instance of the probe.
+        * @param initialCoordinates: Coordinates of the centroids restored before each iteration.
+        * @param config: The configuration.
+        *
+        * @returns (double) The minimum time of the probe iterations.
+      */
+      static double measure(KMeans& probe, const double* initialCoordinates, const KernelConfig& config);
+  };
+}
+
+#endif // K_MEANS_PARALLEL_AUTOTUNER_H
@@ -0,0 +1,319 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <omp.h>
+
+#include "bisecting.h"
+#include "../params.h"
+
+
+namespace Parallel {
+    namespace {
+        // A subset of the points with its statistics.
+        struct Subset {
+            std::vector<long long> indices; // Identifiers of the points of the subset.
+            std::vector<double> mean; // Weighted mean of the points.
+            double weight = 0; // Sum of the weights of the points.
+            double sse = 0; // Weighted sum of the squared distances of the points to the mean.
+        };
+
+        // State shared by the tasks of the recursion.
+        struct Bisector {
+            Points& points; // The points.
+            Centroids& centroids; // The centroids.
+            const Bisection bisection; // Criterion to share the budget of clusters.
+            std::vector<double> clustersSse; // SSE of each found cluster (summed in a fixed order).
+        };
+
+
+        /*
+            * Accumulates the weighted sums of the points of a subset on each side of two centroids, by chunks run as tasks.
+            * Each chunk has its own partial, summed in chunk order, so the result does not depend on the number of threads.
+            *
+            * @param points: The points.
+            * @param indices: Identifiers of the points of the subset.
+            * @param centers: Coordinates of the two centroids (center * dimensions + dim), or the single center of the subset if sides is null.
+            * @param sides: Side of each point of the subset (set by the function if not null).
+            * @param sums: Weighted sums of the coordinates of each side (side * dimensions + dim).
+            * @param weights: Sum of the weights of each side.
+            * @param sse: Weighted sum of the squared distances of each side to its centroid.
+        */
+        void accumulate(const Points& points, const std::vector<long long>& indices, const double* centers, char* sides, double* sums, double* weights, double* sse) {
+            const long long N = points.size, n = indices.size();
+            const int dimensions = points.dimensions;
+            const long long numChunks = (n + BISECTING_GRAIN - 1) / BISECTING_GRAIN;
+            const int width = 2 * (dimensions + 2); // Sums, weight and SSE of the two sides.
+
+            std::vector<double> partials((size_t) numChunks * width, 0);
+
+            for(long long chunk = 0; chunk < numChunks; chunk++) {
+                #pragma omp task default(none) firstprivate(chunk) shared(points, indices, centers, sides, partials, N, n, dimensions, width) if(numChunks > 1)
+                {
+                    double* partial = partials.data() + (size_t) chunk * width;
+                    const long long end = std::min(n, (chunk + 1) * BISECTING_GRAIN);
+
+                    for(long long p = chunk * BISECTING_GRAIN; p < end; p++) {
+                        const long long i = indices[p];
+
+                        // Squared distance to each centroid.
+                        double distances[2] = {0, 0};
+                        for(int dim = 0; dim < dimensions; dim++) {
+                            const double coordinate = points.coordinates[i + N * dim];
+                            distances[0] += (coordinate - centers[dim]) * (coordinate - centers[dim]);
+                            if (sides) {
+                                distances[1] += (coordinate - centers[dimensions + dim]) * (coordinate - centers[dimensions + dim]);
+                            }
+                        }
+
+                        const int side = sides && distances[1] < distances[0] ? 1 : 0;
+                        if (sides) {
+                            sides[p] = side;
+                        }
+
+                        const double weight = points.weights[i];
+                        double* sidePartial = partial + side * (dimensions + 2);
+                        for(int dim = 0; dim < dimensions; dim++) {
+                            sidePartial[dim] += weight * points.coordinates[i + N * dim];
+                        }
+                        sidePartial[dimensions] += weight;
+                        sidePartial[dimensions + 1] += weight * distances[side];
+                    }
+                }
+            }
+            #pragma omp taskwait
+
+            for(int side = 0; side < 2; side++) {
+                for(int dim = 0; dim < dimensions; dim++) {
+                    sums[side * dimensions + dim] = 0;
+                }
+                weights[side] = 0;
+                sse[side] = 0;
+            }
+
+            for(long long chunk = 0; chunk < numChunks; chunk++) {
+                const double* partial = partials.data() + (size_t) chunk * width;
+                for(int side = 0; side < 2; side++) {
+                    for(int dim = 0; dim < dimensions; dim++) {
+                        sums[side * dimensions + dim] += partial[side * (dimensions + 2) + dim];
+                    }
+                    weights[side] += partial[side * (dimensions + 2) + dimensions];
+                    sse[side] += partial[side * (dimensions + 2) + dimensions + 1];
+                }
+            }
+        }
+
+        /*
+            * Computes the weighted mean and SSE of a subset (parallel axis theorem on the accumulated statistics).
+            *
+            * @param subset: The subset (the weight and SSE are given with respect to center).
+            * @param center: The center the SSE was accumulated against.
+            * @param sums: Weighted sums of the coordinates.
+        */
+        void finalize(Subset& subset, const double* center, const double* sums) {
+            const int dimensions = subset.mean.size();
+
+            double shift = 0;
+            for(int dim = 0; dim < dimensions; dim++) {
+                subset.mean[dim] = subset.weight > 0 ? sums[dim] / subset.weight : center[dim];
+                shift += (subset.mean[dim] - center[dim]) * (subset.mean[dim] - center[dim]);
+            }
+
+            // The SSE to the mean is the SSE to the center minus the weight times the squared distance of the mean to the center.
+            subset.sse = std::max(0.0, subset.sse - subset.weight * shift);
+        }
+
+        /*
+            * Splits a subset into two halves with a weighted 2-means.
+            *
+            * @param points: The points.
+            * @param subset: The subset.
+            * @param seed: Seed for the initial centroids.
+            * @param halves: The two halves (filled by the function).
+        */
+        void split(const Points& points, const Subset& subset, const unsigned seed, Subset* halves) {
+            const long long N = points.size, n = subset.indices.size();
+            const int dimensions = points.dimensions;
+
+            // Initial centroids: two random points of the subset (with distinct coordinates if found).
+            std::default_random_engine generator(seed);
+            std::uniform_int_distribution<long long> uniformDistribution(0, n - 1);
+
+            std::vector<double> centers(2 * dimensions);
+            const long long first = subset.indices[uniformDistribution(generator)];
+            long long second = first;
+            for(int attempt = 0; attempt < BISECTING_SEED_ATTEMPTS && second == first; attempt++) {
+                const long long candidate = subset.indices[uniformDistribution(generator)];
+                for(int dim = 0; dim < dimensions; dim++) {
+                    if (points.coordinates[candidate + N * dim] != points.coordinates[first + N * dim]) {
+                        second = candidate;
+                        break;
+                    }
+                }
+            }
+            for(int dim = 0; dim < dimensions; dim++) {
+                centers[dim] = points.coordinates[first + N * dim];
+                centers[dimensions + dim] = points.coordinates[second + N * dim];
+            }
+
+            std::vector<char> sides(n);
+            std::vector<double> assigned(2 * dimensions), sums(2 * dimensions);
+            double weights[2], sse[2];
+
+            for(int iteration = 0; iteration < MAX_ITERATIONS; iteration++) {
+                // Assign the points to the closest of the two centroids.
+                assigned = centers;
+                accumulate(points, subset.indices, assigned.data(), sides.data(), sums.data(), weights, sse);
+
+                // Update the two centroids and check for convergence.
+                bool converged = true;
+                for(int side = 0; side < 2; side++) {
+                    for(int dim = 0; dim < dimensions && weights[side] > 0; dim++) {
+                        const double coordinate = sums[side * dimensions + dim] / weights[side];
+                        if (std::fabs(coordinate - centers[side * dimensions + dim]) > EPSILON) {
+                            converged = false;
+                        }
+                        centers[side * dimensions + dim] = coordinate;
+                    }
+                }
+
+                if (converged) {
+                    break;
+                }
+            }
+
+            // Partition the points with the last assignment and compute the statistics of the halves.
+            for(int side = 0; side < 2; side++) {
+                halves[side].indices.clear();
+                halves[side].mean.assign(dimensions, 0);
+                halves[side].weight = weights[side];
+                halves[side].sse = sse[side];
+                finalize(halves[side], assigned.data() + side * dimensions, sums.data() + side * dimensions);
+            }
+            for(long long p = 0; p < n; p++) {
+                halves[(int) sides[p]].indices.push_back(subset.indices[p]);
+            }
+        }
+
+        /*
+            * Sets a found cluster.
+            *
+            * @param bisector: The state of the bisection.
+            * @param subset: The points of the cluster.
+            * @param j: Identifier of the cluster.
+        */
+        void setCluster(Bisector& bisector, const Subset& subset, const int j) {
+            const int K = bisector.centroids.size, dimensions = bisector.centroids.dimensions;
+
+            for(int dim = 0; dim < dimensions; dim++) {
+                bisector.centroids.coordinates[j + K * dim] = subset.mean[dim];
+            }
+            for(const long long i : subset.indices) {
+                bisector.points.clustersIds[i] = j;
+            }
+            bisector.clustersSse[j] = subset.sse;
+        }
+
+        /*
+            * Greedily splits the cluster with the largest size or SSE until the K clusters are found (or no cluster can be split).
+            * The clusters that cannot be split (identical coordinates) leave the queue, so that their budget goes to the splittable ones.
+            *
+            * @param bisector: The state of the bisection.
+            * @param root: The subset with all the points.
+            * @param K: Number of clusters.
+        */
+        void splitClusters(Bisector& bisector, Subset&& root, const int K) {
+            std::vector<Subset> clusters; // Found clusters (in order of creation).
+            clusters.push_back(std::move(root));
+
+            // Splittable clusters by decreasing score (ties broken by creation order, so that the result is reproducible).
+            const auto score = [&bisector, &clusters](const int c) {
+                return bisector.bisection == LARGEST ? clusters[c].weight : clusters[c].sse;
+            };
+            const auto lower = [&score](const int a, const int b) {
+                return score(a) < score(b) || (score(a) == score(b) && a > b);
+            };
+            std::vector<int> queue = {0};
+
+            for(unsigned splits = 0; (int) clusters.size() < K && !queue.empty(); ) {
+                std::pop_heap(queue.begin(), queue.end(), lower);
+                const int c = queue.back();
+                queue.pop_back();
+
+                if (clusters[c].indices.size() < 2 || clusters[c].sse <= 0) {
+                    continue;
+                }
+
+                Subset halves[2];
+                split(bisector.points, clusters[c], SEED + splits++, halves);
+
+                if (halves[0].indices.empty() || halves[1].indices.empty()) {
+                    // The points cannot be split (identical coordinates).
+                    continue;
+                }
+
+                // The first half replaces the cluster and the second one is a new cluster.
+                clusters[c] = std::move(halves[0]);
+                clusters.push_back(std::move(halves[1]));
+
+                queue.push_back(c);
+                std::push_heap(queue.begin(), queue.end(), lower);
+                queue.push_back(clusters.size() - 1);
+                std::push_heap(queue.begin(), queue.end(), lower);
+            }
+
+            for(int j = 0; j < (int) clusters.size(); j++) {
+                setCluster(bisector, clusters[j], j);
+            }
+
+            // Fewer distinct points than clusters: the extra clusters are empty copies of the last one.
+            for(int j = clusters.size(); j < K; j++) {
+                for(int dim = 0; dim < bisector.centroids.dimensions; dim++) {
+                    bisector.centroids.coordinates[j + K * dim] = clusters.back().mean[dim];
+                }
+            }
+        }
+    }
+
+
+    double bisect(Points& points, Centroids& centroids, const Bisection bisection, const int threads) {
+        const long long N = points.size;
+        const int K = centroids.size, dimensions = points.dimensions;
+
+        Bisector bisector = {points, centroids, bisection, std::vector<double>(K, 0)};
+
+        #pragma omp parallel default(none) shared(bisector, N, K, dimensions) num_threads(threads)
+        #pragma omp single
+        {
+            // The root subset with all the points.
+            Subset root;
+            root.indices.resize(N);
+            for(long long i = 0; i < N; i++) {
+                root.indices[i] = i;
+            }
+            root.mean.assign(dimensions, 0);
+
+            // Statistics of the root (accumulated against the first point to limit the cancellation).
+            std::vector<double> center(dimensions), sums(2 * dimensions);
+            for(int dim = 0; dim < dimensions; dim++) {
+                center[dim] = bisector.points.coordinates[N * dim];
+            }
+            double weights[2], sse[2];
+            accumulate(bisector.points, root.indices, center.data(), nullptr, sums.data(), weights, sse);
+            root.weight = weights[0];
+            root.sse = sse[0];
+            finalize(root, center.data(), sums.data());
+
+            splitClusters(bisector, std::move(root), K);
+        }
+
+        // Inertia of the found clusters (summed in a fixed order).
+        double inertia = 0;
+        for(int j = 0; j < K; j++) {
+            inertia += bisector.clustersSse[j];
+        }
+
+        return inertia;
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef K_MEANS_PARALLEL_BISECTING_H
+#define K_MEANS_PARALLEL_BISECTING_H
+
+#include "points.h"
+#include "centroids.h"
+#include "options.h"
+
+
+namespace Parallel {
+  /*
+    * Bisecting k-means: greedily splits the cluster with the largest size or SSE with a weighted 2-means, until the K clusters are found.
+    * The clusters that cannot be split (identical coordinates) leave the queue, so that the splits go to the other clusters
+    * (the extra clusters are empty only with fewer distinct points than K). The accumulations of a split run as parallel OpenMP tasks.
+    * A split touches the points of one cluster, thus the cost is about O(N log K) instead of the O(NK) of a flat iteration.
+    *
+    * @param points: The points (the identifiers of the clusters are set to the found clusters).
+    * @param centroids: The centroids (the coordinates are set to the means of the found clusters).
+    * @param bisection: Criterion to share the budget of clusters between the halves of a split.
+    * @param threads: Number of threads.
+    *
+    * @returns (double) The weighted inertia of the found clusters.
+  */
+  double bisect(Points& points, Centroids& centroids, const Bisection bisection, const int threads);
+}
+
+#endif // K_MEANS_PARALLEL_BISECTING_H
@@ -1,9 +1,24 @@
+#include <algorithm>
+
 #include "centroids.h"
 
 
 namespace Parallel {
     Centroids::Centroids(const int k, const int d, double* coords, int* ids) : size(k), dimensions(d), coordinates(coords), clustersIds(ids) { }
 
+    Centroids::Centroids(Centroids&& other) : size(other.size), dimensions(other.dimensions), coordinates(other.coordinates), clustersIds(other.clustersIds) {
+        other.coordinates = nullptr;
+        other.clustersIds = nullptr;
+    }
+
+    Centroids Centroids::copy() const {
+        Centroids centroids(size, dimensions, new double[size * dimensions], new int[size]);
+        std::copy(coordinates, coordinates + size * dimensions, centroids.coordinates);
+        std::copy(clustersIds, clustersIds + size, centroids.clustersIds);
+
+        return centroids;
+    }
+
     Centroids::~Centroids() {
         delete[] coordinates;
         delete[] clustersIds;
@@ -22,6 +22,25 @@ namespace Parallel {
     */
     Centroids(const int size, const int dimensions, double* coordinates, int* clustersIds);
 
+    /*
+      * Centroids move constructor.
+      * 
+      * @param other: Centroids whose arrays are moved.
+    */
+    Centroids(Centroids&& other);
+
+    /*
+      * Centroids copy constructor (deleted since the arrays are owned).
+    */
+    Centroids(const Centroids& other) = delete;
+
+    /*
+      * Creates a copy of the centroids with its own arrays.
+      * 
+      * @returns (Centroids) The copy of the centroids.
+    */
+    Centroids copy() const;
+
     /*
       * Centroids destructor.
     */
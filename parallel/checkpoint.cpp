@@ -0,0 +1,104 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "checkpoint.h"
+
+
+namespace Parallel {
+    // Identifier of the checkpoint files (and version of their layout).
+    static const char CHECKPOINT_MAGIC[8] = {'K', 'M', 'E', 'A', 'N', 'S', 'C', '1'};
+
+    // Header of a checkpoint file (followed by the coordinates of the centroids in the SoA layout).
+    struct CheckpointHeader {
+        char magic[8]; // Identifier of the checkpoint files.
+        int K; // Number of clusters.
+        int dimensions; // Number of dimensions.
+        Checkpoint state; // State of the iterations.
+    };
+
+
+    /*
+        * Mixes the bits of a value into a hash (SplitMix64 finalizer).
+        *
+        * @param hash: The hash.
+        * @param value: The value.
+        *
+        * @returns (uint64_t) The mixed hash.
+    */
+    static uint64_t mix(uint64_t hash, const double value) {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        hash ^= bits + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+        hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+        return hash ^ (hash >> 31);
+    }
+
+
+    uint64_t fingerprint(const Points& points, const int threads) {
+        const long long N = points.size;
+        uint64_t result = (uint64_t) N;
+
+        // Hash of each point, combined by a sum (independent of the order of the points, and repeated points don't cancel out as with a XOR).
+        #pragma omp parallel for schedule(static) num_threads(threads) reduction(+:result)
+        for(long long i = 0; i < N; i++) {
+            uint64_t hash = mix(0, points.weights[i]);
+            for(int dim = 0; dim < points.dimensions; dim++) {
+                hash = mix(hash, points.coordinates[i + N * dim]);
+            }
+            result += hash;
+        }
+
+        return result;
+    }
+
+
+    void writeCheckpoint(const std::string& filePath, const Checkpoint& state, const Centroids& centroids) {
+        CheckpointHeader header = {};
+        memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+        header.K = centroids.size;
+        header.dimensions = centroids.dimensions;
+        header.state = state;
+
+        const std::string temporaryPath = filePath + ".tmp";
+        std::ofstream file(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write((const char*) &header, sizeof(header));
+        file.write((const char*) centroids.coordinates, (std::streamsize) centroids.size * centroids.dimensions * sizeof(double));
+        file.close();
+
+        if (!file || rename(temporaryPath.c_str(), filePath.c_str()) != 0) {
+            throw std::runtime_error("ERROR: couldn't write checkpoint " + filePath);
+        }
+    }
+
+    bool readCheckpoint(const std::string& filePath, Checkpoint& state, Centroids& centroids) {
+        std::ifstream file(filePath, std::ios::in | std::ios::binary);
+
+        if (!file.is_open()) {
+            return false;
+        }
+
+        CheckpointHeader header;
+        file.read((char*) &header, sizeof(header));
+
+        if (!file || memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0) {
+            throw std::runtime_error("ERROR: invalid checkpoint " + filePath);
+        }
+        if (header.K != centroids.size || header.dimensions != centroids.dimensions) {
+            throw std::runtime_error("ERROR: the checkpoint " + filePath + " has " + std::to_string(header.K) + " clusters of " + std::to_string(header.dimensions) + " dimensions");
+        }
+
+        file.read((char*) centroids.coordinates, (std::streamsize) centroids.size * centroids.dimensions * sizeof(double));
+
+        if (!file) {
+            throw std::runtime_error("ERROR: truncated checkpoint " + filePath);
+        }
+
+        state = header.state;
+
+        return true;
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef K_MEANS_PARALLEL_CHECKPOINT_H
+#define K_MEANS_PARALLEL_CHECKPOINT_H
+
+#include <string>
+#include <cstdint>
+
+#include "points.h"
+#include "centroids.h"
+#include "options.h"
+
+
+namespace Parallel {
+  // State of the iterations saved in a checkpoint (with the centroids).
+  // The iterations do not draw random numbers (the seeding is the only user of the generator), so no generator state is needed to resume them.
+  struct Checkpoint {
+    long long rows = 0; // Number of original points.
+    uint64_t fingerprint = 0; // Fingerprint of the points.
+    Metric metric = EUCLIDEAN; // Distance metric.
+    int iterations = 0; // Number of completed iterations.
+    bool converged = false; // True if the last iteration converged.
+    double executionTimes = 0; // Execution time of the completed iterations.
+    double inertia = 0; // Inertia of the last iteration.
+
+    long long auditSamples = 0; // Number of audited points.
+    long long auditHits = 0; // Audited points assigned to their exact closest centroid.
+    double auditApproximateInertia = 0; // Inertia of the audited points with the approximate assignment.
+    double auditExactInertia = 0; // Inertia of the audited points with the exact assignment.
+  };
+
+
+  /*
+    * Computes a fingerprint of the points (independent of their order), so that a checkpoint is only resumed on the same points.
+    *
+    * @param points: The points.
+    * @param threads: Number of threads.
+    *
+    * @returns (uint64_t) The fingerprint of the points.
+  */
+  uint64_t fingerprint(const Points& points, const int threads);
+
+  /*
+    * Writes a checkpoint (binary, to a temporary file renamed over the previous checkpoint, so that a preemption never leaves a partial checkpoint).
+    *
+    * @param filePath: Path of the checkpoint file.
+    * @param state: State of the iterations.
+    * @param centroids: The centroids.
+  */
+  void writeCheckpoint(const std::string& filePath, const Checkpoint& state, const Centroids& centroids);
+
+  /*
+    * Reads a checkpoint into the centroids.
+    *
+    * @param filePath: Path of the checkpoint file.
+    * @param state: State of the iterations (filled by the function).
+    * @param centroids: The centroids (filled by the function, they must match the checkpoint).
+    *
+    * @returns (bool) True if the checkpoint exists.
+  */
+  bool readCheckpoint(const std::string& filePath, Checkpoint& state, Centroids& centroids);
+}
+
+#endif // K_MEANS_PARALLEL_CHECKPOINT_H
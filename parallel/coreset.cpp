@@ -0,0 +1,170 @@
+#include <random>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <omp.h>
+
+#include "coreset.h"
+#include "../params.h"
+
+
+namespace Parallel {
+    Points buildCoreset(const Points& points, const int size, const int threads) {
+        const long long N = points.size;
+        const int dimensions = points.dimensions;
+
+        // First pass: weighted mean of the points.
+        std::vector<double> mean(dimensions, 0);
+        double totalWeight = 0;
+
+        #pragma omp parallel for schedule(static) num_threads(threads) reduction(+:totalWeight)
+        for(long long i = 0; i < N; i++) {
+            totalWeight += points.weights[i];
+        }
+
+        for(int dim = 0; dim < dimensions; dim++) {
+            double sum = 0;
+
+            #pragma omp parallel for schedule(static) num_threads(threads) reduction(+:sum)
+            for(long long i = 0; i < N; i++) {
+                sum += points.weights[i] * points.coordinates[i + N * dim];
+            }
+
+            mean[dim] = sum / totalWeight;
+        }
+
+        // Second pass: weighted squared distances to the mean and their prefix sums (by chunks of the threads).
+        std::vector<double> distances(N);
+        std::vector<double> chunksSum(threads + 1, 0);
+
+        #pragma omp parallel num_threads(threads)
+        {
+            const int thread = omp_get_thread_num();
+            const int numThreads = omp_get_num_threads();
+            const long long begin = N * thread / numThreads;
+            const long long end = N * (thread + 1) / numThreads;
+
+            double sum = 0;
+            for(long long i = begin; i < end; i++) {
+                double distance = 0;
+                for(int dim = 0; dim < dimensions; dim++) {
+                    const double difference = points.coordinates[i + N * dim] - mean[dim];
+                    distance += difference * difference;
+                }
+
+                distances[i] = points.weights[i] * distance;
+                sum += distances[i];
+            }
+            chunksSum[thread + 1] = sum;
+
+            #pragma omp barrier
+
+            #pragma omp single
+            for(int t = 1; t <= numThreads; t++) {
+                chunksSum[t] += chunksSum[t - 1];
+            }
+
+            // Replace the distances with the cumulative sampling probabilities.
+            const double totalDistance = chunksSum[numThreads];
+            double cumulative = 0;
+            for(long long i = begin; i < end; i++) {
+                const double probability = 0.5 * points.weights[i] / totalWeight + (totalDistance > 0 ? 0.5 * distances[i] / totalDistance : 0.5 * points.weights[i] / totalWeight);
+
+                cumulative += probability;
+                distances[i] = cumulative;
+            }
+
+            #pragma omp barrier
+
+            // Offset of the chunk (cumulative probability of the previous chunks).
+            #pragma omp single
+            {
+                chunksSum[0] = 0;
+                for(int t = 1; t <= numThreads; t++) {
+                    const long long last = N * t / numThreads - 1;
+                    const long long first = N * (t - 1) / numThreads;
+                    chunksSum[t] = chunksSum[t - 1] + (last >= first ? distances[last] : 0);
+                }
+            }
+
+            for(long long i = begin; i < end; i++) {
+                distances[i] += chunksSum[thread];
+            }
+        }
+        const double totalProbability = distances[N - 1];
+
+        // Sorted uniform samples (with seed for reproducibility).
+        std::default_random_engine generator(SEED);
+        std::uniform_real_distribution<double> uniformDistribution(0, totalProbability);
+        std::vector<double> samples(size);
+        for(int s = 0; s < size; s++) {
+            samples[s] = uniformDistribution(generator);
+        }
+        std::sort(samples.begin(), samples.end());
+
+        // Initialize the points of the coreset.
+        Points coreset(size, dimensions, new double[(size_t) size * dimensions], new long long[size], new int[size], new double[size]);
+
+        // Sample the points by inverse transform (binary search of the cumulative probabilities).
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for(int s = 0; s < size; s++) {
+            const long long i = std::min(N - 1, (long long) (std::upper_bound(distances.begin(), distances.end(), samples[s]) - distances.begin()));
+            const double probability = (distances[i] - (i > 0 ? distances[i - 1] : 0)) / totalProbability;
+
+            for(int dim = 0; dim < dimensions; dim++) {
+                coreset.coordinates[s + size * dim] = points.coordinates[i + N * dim];
+            }
+            coreset.pointsIds[s] = points.pointsIds[i];
+            coreset.clustersIds[s] = -1;
+            coreset.weights[s] = points.weights[i] / (size * probability);
+        }
+
+        return coreset;
+    }
+
+    Points samplePoints(const Points& points, const double fraction, const int seed, const int threads) {
+        const long long N = points.size;
+        const int dimensions = points.dimensions;
+        const long long numBlocks = (N + SAMPLE_BLOCK - 1) / SAMPLE_BLOCK;
+
+        // Sampled points of each block.
+        std::vector<std::vector<long long>> blocks(numBlocks);
+
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for(long long block = 0; block < numBlocks; block++) {
+            std::mt19937_64 generator((uint64_t) seed * 0x9E3779B97F4A7C15ULL + block);
+            std::geometric_distribution<long long> gaps(fraction);
+
+            const long long end = std::min(N, (block + 1) * SAMPLE_BLOCK);
+            for(long long i = block * SAMPLE_BLOCK + gaps(generator); i < end; i += 1 + gaps(generator)) {
+                blocks[block].push_back(i);
+            }
+        }
+
+        // Offsets of the blocks in the sample.
+        std::vector<long long> offsets(numBlocks + 1, 0);
+        for(long long block = 0; block < numBlocks; block++) {
+            offsets[block + 1] = offsets[block] + blocks[block].size();
+        }
+        const long long size = offsets[numBlocks];
+
+        // Copy the sampled points.
+        Points sample(size, dimensions, new double[(size_t) size * dimensions], new long long[size], new int[size], new double[size]);
+
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for(long long block = 0; block < numBlocks; block++) {
+            for(size_t s = 0; s < blocks[block].size(); s++) {
+                const long long i = blocks[block][s], p = offsets[block] + s;
+
+                for(int dim = 0; dim < dimensions; dim++) {
+                    sample.coordinates[p + size * dim] = points.coordinates[i + N * dim];
+                }
+                sample.pointsIds[p] = points.pointsIds[i];
+                sample.clustersIds[p] = -1;
+                sample.weights[p] = points.weights[i];
+            }
+        }
+
+        return sample;
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef K_MEANS_PARALLEL_CORESET_H
+#define K_MEANS_PARALLEL_CORESET_H
+
+#include "points.h"
+
+
+namespace Parallel {
+  /*
+    * Builds a lightweight coreset of the points with sensitivity sampling (two parallel passes over the points).
+    * Each point is sampled with probability q = 1/2 * w/W + 1/2 * w*d^2/sum(w*d^2), where d is the distance to the (weighted) mean,
+    * and weighted by w/(m*q), so that the weighted inertia of the coreset approximates the one of the points for any centroids.
+    *
+    * @param points: The points.
+    * @param size: Number of points of the coreset (m).
+    * @param threads: Number of threads.
+    *
+    * @returns (Points) The weighted points of the coreset (the identifier of a point is its original point).
+  */
+  Points buildCoreset(const Points& points, const int size, const int threads);
+
+  /*
+    * Draws a uniform subsample of the points in parallel (each point is kept with the given probability).
+    * Each block of SAMPLE_BLOCK points has its own generator (skipping ahead by geometric gaps), so that the sample does not depend on the number of threads.
+    *
+    * @param points: The points.
+    * @param fraction: Probability of keeping a point.
+    * @param seed: Seed of the generators.
+    * @param threads: Number of threads.
+    *
+    * @returns (Points) The sampled points (with their weights, the identifier of a point is its original point).
+  */
+  Points samplePoints(const Points& points, const double fraction, const int seed, const int threads);
+}
+
+#endif // K_MEANS_PARALLEL_CORESET_H
@@ -0,0 +1,175 @@
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <omp.h>
+
+#include "dedupe.h"
+
+
+namespace Parallel {
+    /*
+        * Hashes the coordinates of a point (bitwise, so that only exactly repeated coordinates collide).
+        *
+        * @param points: The points.
+        * @param i: The identifier of the point.
+        *
+        * @returns (uint64_t) The hash of the point.
+    */
+    static uint64_t hashPoint(const Points& points, const long long i) {
+        uint64_t hash = 14695981039346656037ULL; // FNV offset basis.
+
+        for(int dim = 0; dim < points.dimensions; dim++) {
+            uint64_t bits;
+            memcpy(&bits, &points.coordinates[i + points.size * dim], sizeof(bits));
+
+            // Mix the bits of the coordinate.
+            hash ^= bits + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+            hash *= 1099511628211ULL; // FNV prime.
+        }
+
+        return hash;
+    }
+
+    /*
+        * Checks if two points have exactly the same coordinates.
+        *
+        * @param points: The points.
+        * @param a: The identifier of the first point.
+        * @param b: The identifier of the second point.
+        *
+        * @returns (bool) True if the coordinates are identical, false otherwise.
+    */
+    static bool samePoint(const Points& points, const long long a, const long long b) {
+        for(int dim = 0; dim < points.dimensions; dim++) {
+            if (memcmp(&points.coordinates[a + points.size * dim], &points.coordinates[b + points.size * dim], sizeof(double)) != 0) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    Points deduplicate(const Points& points, std::vector<long long>& rowToPoint, const int threads) {
+        const long long N = points.size;
+        const int dimensions = points.dimensions;
+        const int numShards = threads * 8; // Number of shards of the hashes.
+
+        // Hashes of the points.
+        std::vector<uint64_t> hashes(N);
+        // Representative (first occurrence) of each point.
+        std::vector<long long> representatives(N);
+        // Points of each shard (grouped with a counting sort).
+        std::vector<long long> shardsPoints(N);
+        std::vector<long long> shardsOffsets(numShards + 1, 0);
+        std::vector<long long> threadsCounts((size_t) threads * numShards, 0);
+
+        #pragma omp parallel num_threads(threads)
+        {
+            const int thread = omp_get_thread_num();
+            long long* counts = &threadsCounts[(size_t) thread * numShards];
+
+            // Hash the points and count them by shard.
+            #pragma omp for schedule(static)
+            for(long long i = 0; i < N; i++) {
+                hashes[i] = hashPoint(points, i);
+                counts[hashes[i] % numShards]++;
+            }
+
+            // Compute the offsets of each shard and thread (in point order).
+            #pragma omp single
+            {
+                long long offset = 0;
+                for(int shard = 0; shard < numShards; shard++) {
+                    shardsOffsets[shard] = offset;
+                    for(int t = 0; t < omp_get_num_threads(); t++) {
+                        const long long count = threadsCounts[(size_t) t * numShards + shard];
+                        threadsCounts[(size_t) t * numShards + shard] = offset;
+                        offset += count;
+                    }
+                }
+                shardsOffsets[numShards] = offset;
+            }
+
+            // Scatter the points into their shard (same static partition, so each shard keeps the point order).
+            #pragma omp for schedule(static)
+            for(long long i = 0; i < N; i++) {
+                shardsPoints[counts[hashes[i] % numShards]++] = i;
+            }
+
+            // Group the identical points of each shard.
+            #pragma omp for schedule(dynamic)
+            for(int shard = 0; shard < numShards; shard++) {
+                long long* first = &shardsPoints[shardsOffsets[shard]];
+                long long* last = &shardsPoints[shardsOffsets[shard + 1]];
+
+                // Sort by hash, keeping the point order among equal hashes.
+                std::stable_sort(first, last, [&hashes](const long long a, const long long b) { return hashes[a] < hashes[b]; });
+
+                for(long long* group = first; group < last; ) {
+                    // Points with the same hash.
+                    long long* groupEnd = group;
+                    while (groupEnd < last && hashes[*groupEnd] == hashes[*group]) groupEnd++;
+
+                    // Assign each point to the first identical point of the group (points sharing a hash but not coordinates are kept apart).
+                    for(long long* p = group; p < groupEnd; p++) {
+                        representatives[*p] = *p;
+                        for(long long* q = group; q < p; q++) {
+                            if (representatives[*q] == *q && samePoint(points, *p, *q)) {
+                                representatives[*p] = *q;
+                                break;
+                            }
+                        }
+                    }
+
+                    group = groupEnd;
+                }
+            }
+        }
+
+        // Index the unique points in order of first occurrence.
+        std::vector<long long> uniqueIndices(N);
+        long long numUnique = 0;
+        for(long long i = 0; i < N; i++) {
+            uniqueIndices[i] = numUnique;
+            if (representatives[i] == i) {
+                numUnique++;
+            }
+        }
+
+        // Map each original point to its unique point.
+        rowToPoint.resize(N);
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for(long long i = 0; i < N; i++) {
+            rowToPoint[i] = uniqueIndices[representatives[i]];
+        }
+
+        // Gather the unique points.
+        Points unique(numUnique, dimensions, new double[(size_t) numUnique * dimensions], new long long[numUnique], new int[numUnique], new double[numUnique]);
+        unique.firstTouch(threads);
+
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for(long long i = 0; i < N; i++) {
+            if (representatives[i] == i) {
+                const long long u = rowToPoint[i];
+                for(int dim = 0; dim < dimensions; dim++) {
+                    unique.coordinates[u + numUnique * dim] = points.coordinates[i + N * dim];
+                }
+                unique.pointsIds[u] = points.pointsIds[i];
+                unique.clustersIds[u] = -1;
+                unique.weights[u] = 0;
+            }
+        }
+
+        // Accumulate the weights of the identical points (in point order).
+        for(long long i = 0; i < N; i++) {
+            unique.weights[rowToPoint[i]] += points.weights[i];
+        }
+
+        std::cout << "Deduplicated " << N << " points into " << numUnique << " unique weighted points (duplication factor " << (double) N / numUnique << ")." << std::endl;
+
+        return unique;
+    }
+}
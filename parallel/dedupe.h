@@ -0,0 +1,22 @@
+#ifndef K_MEANS_PARALLEL_DEDUPE_H
+#define K_MEANS_PARALLEL_DEDUPE_H
+
+#include <vector>
+
+#include "points.h"
+
+
+namespace Parallel {
+  /*
+    * Collapses the points with identical coordinates into a single point weighted by the sum of their weights (parallel hashing pre-pass).
+    *
+    * @param points: The points.
+    * @param rowToPoint: Vector mapping each original point to its unique point (filled by the function).
+    * @param threads: Number of threads.
+    *
+    * @returns (Points) The unique points, in order of first occurrence (the identifier of a unique point is its first original point).
+  */
+  Points deduplicate(const Points& points, std::vector<long long>& rowToPoint, const int threads);
+}
+
+#endif // K_MEANS_PARALLEL_DEDUPE_H
@@ -0,0 +1,269 @@
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <float.h>
+#include <omp.h>
+
+#include "evaluation.h"
+#include "metrics.h"
+#include "../params.h"
+
+
+namespace Parallel {
+    /*
+        * Finishes a distance of a metric policy (the Euclidean distance is not squared).
+        *
+        * @param sum: Sum of the terms of the dimensions.
+        *
+        * @returns (double) The distance.
+    */
+    template <typename Metric>
+    static inline double finish(const double sum) {
+        return Metric::metric == EUCLIDEAN ? sqrt(sum) : std::max(0.0, Metric::finish(sum));
+    }
+
+    /*
+        * Computes the silhouette of points (a tile of evaluated points at a time, streaming all the points).
+        *
+        * @param points: The points.
+        * @param K: Number of clusters.
+        * @param clusterWeights: Total weight of each cluster.
+        * @param evaluated: Identifiers of the evaluated points.
+        * @param silhouettes: Silhouette of each evaluated point (filled by the function).
+        * @param threads: Number of threads.
+    */
+    template <typename Metric>
+    static void computeSilhouettes(const Points& points, const int K, const std::vector<double>& clusterWeights, const std::vector<long long>& evaluated, std::vector<double>& silhouettes, const int threads) {
+        const long long N = points.size;
+        const int dimensions = points.dimensions;
+        const long long size = evaluated.size();
+        const long long numTiles = (size + EVALUATION_TILE - 1) / EVALUATION_TILE;
+
+        #pragma omp parallel num_threads(threads)
+        {
+            // Buffers of the thread for the coordinates of a tile and its weighted sums of distances to each cluster.
+            std::vector<double> tile(EVALUATION_TILE * dimensions);
+            std::vector<double> sums(EVALUATION_TILE * K);
+
+            #pragma omp for schedule(dynamic)
+            for(long long t = 0; t < numTiles; t++) {
+                const long long begin = t * EVALUATION_TILE;
+                const int tileSize = (int) (std::min(size, begin + EVALUATION_TILE) - begin);
+
+                for(int p = 0; p < tileSize; p++) {
+                    for(int dim = 0; dim < dimensions; dim++) {
+                        tile[p * dimensions + dim] = points.coordinates[evaluated[begin + p] + N * dim];
+                    }
+                }
+                std::fill(sums.begin(), sums.end(), 0);
+
+                for(long long i = 0; i < N; i++) {
+                    const int cluster = points.clustersIds[i];
+
+                    for(int p = 0; p < tileSize; p++) {
+                        double sum = 0;
+                        for(int dim = 0; dim < dimensions; dim++) {
+                            sum += Metric::term(points.coordinates[i + N * dim], tile[p * dimensions + dim]);
+                        }
+                        sums[p * K + cluster] += points.weights[i] * finish<Metric>(sum);
+                    }
+                }
+
+                for(int p = 0; p < tileSize; p++) {
+                    const int own = points.clustersIds[evaluated[begin + p]];
+
+                    // Mean distance to the other points of its cluster (its duplicates are at distance 0) and to the closest other cluster.
+                    const double a = clusterWeights[own] > 1 ? sums[p * K + own] / (clusterWeights[own] - 1) : 0;
+                    double b = DBL_MAX;
+                    for(int j = 0; j < K; j++) {
+                        if (j != own && clusterWeights[j] > 0) {
+                            b = std::min(b, sums[p * K + j] / clusterWeights[j]);
+                        }
+                    }
+
+                    silhouettes[begin + p] = clusterWeights[own] > 1 && b < DBL_MAX && std::max(a, b) > 0 ? (b - a) / std::max(a, b) : 0;
+                }
+            }
+        }
+    }
+
+    template <typename Metric>
+    static Evaluation evaluate(const Points& points, const Centroids& centroids, const int threads) {
+        const long long N = points.size;
+        const int K = centroids.size, dimensions = centroids.dimensions;
+        Evaluation evaluation;
+
+        // Weight, number of points and sum of the distances to the centroid of each cluster (one pass with per-thread partials).
+        std::vector<double> clusterWeights(K, 0), clusterDistances(K, 0);
+        std::vector<long long> clusterSizes(K, 0);
+        double within = 0; // Weighted sum of the terms of the distances (the squared distances with the Euclidean metric).
+
+        #pragma omp parallel num_threads(threads) reduction(+:within)
+        {
+            std::vector<double> weights(K, 0), distances(K, 0);
+            std::vector<long long> sizes(K, 0);
+
+            #pragma omp for schedule(static)
+            for(long long i = 0; i < N; i++) {
+                const int j = points.clustersIds[i];
+
+                double sum = 0;
+                for(int dim = 0; dim < dimensions; dim++) {
+                    sum += Metric::term(points.coordinates[i + N * dim], centroids.coordinates[j + K * dim]);
+                }
+
+                weights[j] += points.weights[i];
+                distances[j] += points.weights[i] * finish<Metric>(sum);
+                sizes[j]++;
+                within += points.weights[i] * sum;
+            }
+
+            #pragma omp critical
+            for(int j = 0; j < K; j++) {
+                clusterWeights[j] += weights[j];
+                clusterDistances[j] += distances[j];
+                clusterSizes[j] += sizes[j];
+            }
+        }
+
+        double totalWeight = 0;
+        int nonEmpty = 0;
+        for(int j = 0; j < K; j++) {
+            totalWeight += clusterWeights[j];
+            nonEmpty += clusterWeights[j] > 0;
+        }
+
+        // Davies-Bouldin: mean over the clusters of the worst ratio of the scatters to the separation of the centroids.
+        for(int i = 0; i < K; i++) {
+            if (clusterWeights[i] == 0) continue;
+
+            double worst = 0;
+            for(int j = 0; j < K; j++) {
+                if (j == i || clusterWeights[j] == 0) continue;
+
+                double sum = 0;
+                for(int dim = 0; dim < dimensions; dim++) {
+                    sum += Metric::term(centroids.coordinates[i + K * dim], centroids.coordinates[j + K * dim]);
+                }
+                const double separation = finish<Metric>(sum);
+
+                if (separation > 0) {
+                    worst = std::max(worst, (clusterDistances[i] / clusterWeights[i] + clusterDistances[j] / clusterWeights[j]) / separation);
+                }
+            }
+            evaluation.daviesBouldin += worst / nonEmpty;
+        }
+
+        if (Metric::metric == EUCLIDEAN && nonEmpty > 1 && totalWeight > nonEmpty) {
+            // Calinski-Harabasz: ratio of the between and within-cluster dispersions (the centroids are the weighted means of their clusters).
+            double between = 0;
+            for(int dim = 0; dim < dimensions; dim++) {
+                double mean = 0;
+                for(int j = 0; j < K; j++) {
+                    mean += clusterWeights[j] * centroids.coordinates[j + K * dim];
+                }
+                mean /= totalWeight;
+
+                for(int j = 0; j < K; j++) {
+                    const double difference = centroids.coordinates[j + K * dim] - mean;
+                    between += clusterWeights[j] * difference * difference;
+                }
+            }
+
+            evaluation.calinskiHarabasz = within > 0 ? (between / (nonEmpty - 1)) / (within / (totalWeight - nonEmpty)) : 0;
+        }
+
+        // Evaluated points of the silhouette (all of them, or a sample stratified by cluster).
+        std::vector<long long> evaluated;
+        std::vector<int> strataSizes(K, 0);
+        evaluation.exact = N <= SILHOUETTE_EXACT;
+
+        if (evaluation.exact) {
+            evaluated.resize(N);
+            for(long long i = 0; i < N; i++) {
+                evaluated[i] = i;
+            }
+        } else {
+            // Points of each cluster.
+            std::vector<std::vector<long long>> members(K);
+            for(int j = 0; j < K; j++) {
+                members[j].reserve(clusterSizes[j]);
+            }
+            for(long long i = 0; i < N; i++) {
+                members[points.clustersIds[i]].push_back(i);
+            }
+
+            // Proportional allocation (at least 2 points per cluster for the variance), drawn without replacement.
+            std::default_random_engine generator(SEED);
+            for(int j = 0; j < K; j++) {
+                const long long allocation = std::llround((double) SILHOUETTE_SAMPLE * clusterSizes[j] / N);
+                strataSizes[j] = (int) std::min(clusterSizes[j], std::max(2LL, allocation));
+
+                for(int s = 0; s < strataSizes[j]; s++) {
+                    std::uniform_int_distribution<long long> distribution(s, clusterSizes[j] - 1);
+                    std::swap(members[j][s], members[j][distribution(generator)]);
+                    evaluated.push_back(members[j][s]);
+                }
+            }
+        }
+
+        std::vector<double> values(evaluated.size());
+        computeSilhouettes<Metric>(points, K, clusterWeights, evaluated, values, threads);
+        evaluation.silhouettePoints = evaluated.size();
+
+        if (evaluation.exact) {
+            // Mean over the points (with their multiplicities).
+            double sum = 0;
+            for(long long i = 0; i < N; i++) {
+                sum += points.weights[i] * values[i];
+            }
+            evaluation.silhouette = evaluation.silhouetteLow = evaluation.silhouetteHigh = sum / totalWeight;
+        } else {
+            // Stratified estimate of the mean and of its variance (with the finite population correction).
+            double mean = 0, variance = 0;
+            long long offset = 0;
+            for(int j = 0; j < K; j++) {
+                const int n = strataSizes[j];
+                if (n == 0) continue;
+
+                double weight = 0, sum = 0;
+                for(int s = 0; s < n; s++) {
+                    weight += points.weights[evaluated[offset + s]];
+                    sum += points.weights[evaluated[offset + s]] * values[offset + s];
+                }
+                const double stratumMean = sum / weight;
+
+                double squares = 0;
+                for(int s = 0; s < n; s++) {
+                    squares += (values[offset + s] - stratumMean) * (values[offset + s] - stratumMean);
+                }
+
+                const double share = clusterWeights[j] / totalWeight;
+                mean += share * stratumMean;
+                if (n > 1) {
+                    variance += share * share * (squares / (n - 1)) / n * (1 - (double) n / clusterSizes[j]);
+                }
+                offset += n;
+            }
+
+            const double margin = 1.96 * sqrt(variance);
+            evaluation.silhouette = mean;
+            evaluation.silhouetteLow = mean - margin;
+            evaluation.silhouetteHigh = mean + margin;
+        }
+
+        return evaluation;
+    }
+
+
+    Evaluation evaluate(const Points& points, const Centroids& centroids, const Metric metric, const int threads) {
+        if (metric == COSINE) {
+            return evaluate<Cosine>(points, centroids, threads);
+        } else if (metric == MANHATTAN) {
+            return evaluate<Manhattan>(points, centroids, threads);
+        }
+
+        return evaluate<SquaredEuclidean>(points, centroids, threads);
+    }
+}
@@ -0,0 +1,39 @@
+#ifndef K_MEANS_PARALLEL_EVALUATION_H
+#define K_MEANS_PARALLEL_EVALUATION_H
+
+#include "points.h"
+#include "centroids.h"
+#include "options.h"
+
+
+namespace Parallel {
+  // Quality metrics of a clustering.
+  struct Evaluation {
+    double daviesBouldin = 0; // Davies-Bouldin index (lower is better).
+    double calinskiHarabasz = 0; // Calinski-Harabasz index (higher is better, only with the Euclidean metric).
+    double silhouette = 0; // Mean silhouette coefficient (in [-1, 1], higher is better).
+    double silhouetteLow = 0; // Lower bound of the 95% confidence interval of the silhouette (equal to the silhouette if exact).
+    double silhouetteHigh = 0; // Upper bound of the 95% confidence interval of the silhouette (equal to the silhouette if exact).
+    long long silhouettePoints = 0; // Number of points whose silhouette was computed.
+    bool exact = true; // True if the silhouette was computed on all the points.
+  };
+
+
+  /*
+    * Evaluates the quality of the assignment of the points to the centroids (blocked and in parallel).
+    * The Davies-Bouldin and Calinski-Harabasz indices are exact (one pass over the points).
+    * The silhouette is exact for at most SILHOUETTE_EXACT points (O(N^2)), and otherwise estimated on a sample of SILHOUETTE_SAMPLE points
+    * stratified by cluster (each sampled point against all the points), with a 95% confidence interval.
+    * The weights of the points are their multiplicities.
+    *
+    * @param points: The points (assigned to the centroids).
+    * @param centroids: The centroids.
+    * @param metric: Distance metric (the Euclidean distance is not squared).
+    * @param threads: Number of threads.
+    *
+    * @returns (Evaluation) The quality metrics.
+  */
+  Evaluation evaluate(const Points& points, const Centroids& centroids, const Metric metric, const int threads);
+}
+
+#endif // K_MEANS_PARALLEL_EVALUATION_H
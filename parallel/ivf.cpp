@@ -0,0 +1,145 @@
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <omp.h>
+
+#include "ivf.h"
+
+
+namespace Parallel {
+    CentroidIndex::CentroidIndex(const int l, const int p) : lists(l), nprobe(std::max(1, p)) { }
+
+
+    void CentroidIndex::build(const Centroids& centroids) {
+        const int K = centroids.size;
+
+        #pragma omp single
+        {
+            numLists = std::max(1, std::min(K, lists > 0 ? lists : (int) std::lround(std::sqrt((double) K))));
+            dimensions = centroids.dimensions;
+
+            // Coarse centers: centroids evenly strided over the identifiers.
+            coarse.resize((size_t) numLists * dimensions);
+            for(int c = 0; c < numLists; c++) {
+                const int j = (int) ((long long) c * K / numLists);
+                for(int dim = 0; dim < dimensions; dim++) {
+                    coarse[(size_t) c * dimensions + dim] = centroids.coordinates[j + K * dim];
+                }
+            }
+
+            centroidLists.resize(K);
+            offsets.assign(numLists + 1, 0);
+            ids.resize(K);
+            coordinates.resize((size_t) K * dimensions);
+
+            // Buffers of the threads.
+            scratch.resize(omp_get_num_threads());
+            for(Scratch& threadScratch : scratch) {
+                threadScratch.point.resize(dimensions);
+                threadScratch.probeDistances.resize(std::min(nprobe, numLists));
+                threadScratch.probes.resize(std::min(nprobe, numLists));
+            }
+        }
+
+        // Assign each centroid to the closest coarse center.
+        #pragma omp for schedule(static)
+        for(int j = 0; j < K; j++) {
+            double minDistance = DBL_MAX;
+            int minList = 0;
+
+            for(int c = 0; c < numLists; c++) {
+                double distance = 0;
+                for(int dim = 0; dim < dimensions; dim++) {
+                    const double difference = centroids.coordinates[j + K * dim] - coarse[(size_t) c * dimensions + dim];
+                    distance += difference * difference;
+                }
+
+                if (distance < minDistance) {
+                    minDistance = distance;
+                    minList = c;
+                }
+            }
+
+            centroidLists[j] = minList;
+        }
+
+        // Group the centroids by list (counting sort, stable in the identifiers).
+        #pragma omp single
+        {
+            for(int j = 0; j < K; j++) {
+                offsets[centroidLists[j] + 1]++;
+            }
+            for(int c = 0; c < numLists; c++) {
+                offsets[c + 1] += offsets[c];
+            }
+
+            std::vector<int> positions(offsets.begin(), offsets.end() - 1);
+            for(int j = 0; j < K; j++) {
+                ids[positions[centroidLists[j]]++] = j;
+            }
+        }
+
+        // Copy the coordinates of the centroids in list order (contiguous scans of the lists).
+        #pragma omp for schedule(static)
+        for(int p = 0; p < K; p++) {
+            for(int dim = 0; dim < dimensions; dim++) {
+                coordinates[(size_t) p * dimensions + dim] = centroids.coordinates[ids[p] + K * dim];
+            }
+        }
+    }
+
+    void CentroidIndex::search(const double* pointCoordinates, const long long stride, int& id, double& distance) {
+        Scratch& threadScratch = scratch[omp_get_thread_num()];
+        double* point = threadScratch.point.data();
+        double* probeDistances = threadScratch.probeDistances.data();
+        int* probes = threadScratch.probes.data();
+        const int numProbes = threadScratch.probes.size();
+
+        // Gather the coordinates of the point.
+        for(int dim = 0; dim < dimensions; dim++) {
+            point[dim] = pointCoordinates[dim * stride];
+        }
+
+        // Select the closest coarse centers (insertion into the sorted probes).
+        int count = 0;
+        for(int c = 0; c < numLists; c++) {
+            const double* center = &coarse[(size_t) c * dimensions];
+            double coarseDistance = 0;
+            #pragma omp simd reduction(+:coarseDistance)
+            for(int dim = 0; dim < dimensions; dim++) {
+                coarseDistance += (center[dim] - point[dim]) * (center[dim] - point[dim]);
+            }
+
+            if (count < numProbes || coarseDistance < probeDistances[count - 1]) {
+                int position = count < numProbes ? count++ : count - 1;
+                while (position > 0 && probeDistances[position - 1] > coarseDistance) {
+                    probeDistances[position] = probeDistances[position - 1];
+                    probes[position] = probes[position - 1];
+                    position--;
+                }
+                probeDistances[position] = coarseDistance;
+                probes[position] = c;
+            }
+        }
+
+        // Scan the centroids of the selected lists.
+        distance = DBL_MAX;
+        id = -1;
+        for(int probe = 0; probe < count; probe++) {
+            for(int p = offsets[probes[probe]]; p < offsets[probes[probe] + 1]; p++) {
+                const double* centroid = &coordinates[(size_t) p * dimensions];
+                double centroidDistance = 0;
+                #pragma omp simd reduction(+:centroidDistance)
+                for(int dim = 0; dim < dimensions; dim++) {
+                    centroidDistance += (centroid[dim] - point[dim]) * (centroid[dim] - point[dim]);
+                }
+
+                // Ties are broken by the smallest identifier (as the exact engines).
+                if (centroidDistance < distance || (centroidDistance == distance && ids[p] < id)) {
+                    distance = centroidDistance;
+                    id = ids[p];
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef K_MEANS_PARALLEL_IVF_H
+#define K_MEANS_PARALLEL_IVF_H
+
+#include <vector>
+#include <algorithm>
+
+#include "centroids.h"
+
+
+namespace Parallel {
+  // Inverted-file index over the centroids for the approximate search of the closest centroid.
+  // The centroids are partitioned into lists by their closest coarse center (a strided subset of the centroids),
+  // and a query only scans the lists of its nprobe closest coarse centers.
+  class CentroidIndex {
+    public:
+      /*
+        * CentroidIndex constructor.
+        *
+        * @param lists: Number of lists (0 for the square root of the number of centroids).
+        * @param nprobe: Number of lists scanned by a query (recall knob, exact search if not less than the number of lists).
+      */
+      CentroidIndex(const int lists, const int nprobe);
+
+
+      /*
+        * Builds the index over the current centroids (must be called by all the threads of a parallel region).
+        *
+        * @param centroids: The centroids.
+      */
+      void build(const Centroids& centroids);
+
+      /*
+        * Searches the (approximate) closest centroid of a point (uses the scratch of the calling thread).
+        *
+        * @param coordinates: Pointer to the first coordinate of the point.
+        * @param stride: Distance between two coordinates of the point (SoA layout).
+        * @param id: Identifier of the closest centroid found.
+        * @param distance: Squared distance to the closest centroid found.
+      */
+      void search(const double* coordinates, const long long stride, int& id, double& distance);
+
+
+      /*
+        * Gets the number of lists of the index.
+        *
+        * @returns (int) The number of lists.
+      */
+      int getLists() const { return numLists; }
+
+      /*
+        * Gets the number of lists scanned by a query.
+        *
+        * @returns (int) The number of lists scanned by a query.
+      */
+      int getProbes() const { return std::min(nprobe, numLists); }
+
+    private:
+      // Buffers of a thread for the queries (aligned to avoid false sharing).
+      struct alignas(64) Scratch {
+        std::vector<double> point; // Gathered coordinates of the point.
+        std::vector<double> probeDistances; // Squared distances to the closest coarse centers (sorted).
+        std::vector<int> probes; // Closest coarse centers.
+      };
+
+      const int lists; // Requested number of lists (0 for the square root of the number of centroids).
+      const int nprobe; // Number of lists scanned by a query.
+
+      int numLists = 0; // Number of lists of the current index.
+      int dimensions = 0; // Number of dimensions.
+
+      std::vector<double> coarse; // Coordinates of the coarse centers (row-major).
+      std::vector<int> centroidLists; // List of each centroid.
+      std::vector<int> offsets; // Offset of each list in the centroids of the lists.
+      std::vector<int> ids; // Identifiers of the centroids of the lists (grouped by list).
+      std::vector<double> coordinates; // Coordinates of the centroids of the lists (row-major, grouped by list).
+
+      std::vector<Scratch> scratch; // Buffers of each thread.
+  };
+}
+
+#endif // K_MEANS_PARALLEL_IVF_H
@@ -3,37 +3,54 @@
 #include <cmath>
 #include <vector>
 #include <set>
+#include <memory>
+#include <fstream>
+#include <sstream>
 #include <float.h>
 #include <omp.h>
 
 #include "kmeans.h"
+#include "autotuner.h"
+#include "loader.h"
+#include "checkpoint.h"
+#include "writer.h"
+#include "evaluation.h"
+#include "dedupe.h"
+#include "reorder.h"
+#include "coreset.h"
+#include "bisecting.h"
+#include "ivf.h"
+#include "metrics.h"
+#include "quantized.h"
 #include "../utils.h"
 #include "../params.h"
 
 
 namespace Parallel {
-    KMeans::KMeans(const int n, const int k, const int d, const int t) : N(n), K(k), dimensions(d), threads(t), points(initializeRandomPoints()), centroids(initializeCentroids()) { }
+    KMeans::KMeans(const long long n, const int k, const int d, const int t, const Options& o) : N(n), K(k), dimensions(d), threads(t), options(o), kernel(o.kernel), tracer(o.trace, t, constructionTime), reservoir(o.pipeline ? k : 0, SEED), points(preprocessPoints(initializeRandomPoints())), centroids(initializeCentroids()), profiler(o.profile, t), pool(o.schedule, t), index(o.lists, o.nprobe), projection(o.sketchDimensions, o.shortlist) { }
 
-    KMeans::KMeans(const std::string& filePath, const int k, const int t) : filePath(filePath), K(k), threads(t), points(initializeInputPoints()), centroids(initializeCentroids()) { }
+    KMeans::KMeans(const std::string& filePath, const int k, const int t, const Options& o) : filePath(filePath), K(k), threads(t), options(o), kernel(o.kernel), tracer(o.trace, t, constructionTime), reservoir(o.pipeline ? k : 0, SEED), points(preprocessPoints(initializeInputPoints())), centroids(initializeCentroids()), profiler(o.profile, t), pool(o.schedule, t), index(o.lists, o.nprobe), projection(o.sketchDimensions, o.shortlist) { }
+
+    KMeans::KMeans(Points&& p, Centroids&& c, const int t, const Options& o) : N(p.size), K(c.size), dimensions(p.dimensions), threads(t), options(o), kernel(o.kernel), tracer(o.trace, t, constructionTime), reservoir(0, SEED), rows(p.size), points(std::move(p)), centroids(std::move(c)), profiler(o.profile, t), pool(o.schedule, t), index(o.lists, o.nprobe), projection(o.sketchDimensions, o.shortlist) { }
+
+    KMeans::KMeans(Points&& p, const int k, const int t, const Options& o) : N(p.size), K(k), dimensions(p.dimensions), threads(t), options(o), kernel(o.kernel), tracer(o.trace, t, constructionTime), reservoir(o.pipeline ? k : 0, SEED), points(preprocessPoints(std::move(p))), centroids(initializeCentroids()), profiler(o.profile, t), pool(o.schedule, t), index(o.lists, o.nprobe), projection(o.sketchDimensions, o.shortlist) { }
 
 
     void KMeans::run(const std::string &basePath, const bool log) {
-        // Set the number of threads.
-        omp_set_num_threads(threads);
+        // Check the options and configure the threads and the kernel.
+        configure();
 
         std::cout << "Running parallel k-means with " << N << " points and " << K << " clusters using #" << omp_get_max_threads() << " threads." << std::endl;
 
-        // Variables for convergence.
-        int iterations = 0;
-        bool converged = false;
-
         // Variable for execution times.
         double executionTimes = 0;
         FolderPaths paths;
 
+        // Weighted sum of the squared distances of the points to their centroid.
+        double inertia = 0;
+
         // Variable for logging.
-        std::string initMode = filePath.empty() ? "random" : "input";
-        bool canPlot = log && (dimensions == 2 || dimensions == 3);
+        bool canPlot = log && (dimensions == 2 || dimensions == 3) && options.coresetSize == 0 && !options.bisecting;
         if (!canPlot) {
             std::cout << "LOG is disabled (" << (log ? "LOG=true" : "LOG=false") << ") or cannot plot points with specified dimensions (DIMENSIONS=" << dimensions << ")." << std::endl;
         }
@@ -41,17 +58,194 @@ namespace Parallel {
         // Create the folders for the results.
         paths = create_folders(basePath, "parallel", N, K, dimensions, canPlot);
 
+        // Initial centroids for the comparison with the double precision engine.
+        Centroids initialCentroids = options.precision != DOUBLE ? centroids.copy() : Centroids(0, dimensions, nullptr, nullptr);
+
+        // Execute the algorithm.
+        const int iterations = execute(paths, canPlot, executionTimes, inertia);
+
+        if(canPlot) {
+            // Convert to gif.
+            convert_gif(iterations, executionTimes, paths, "parallel");
+        }
+
+        std::cout << "Converged after " << iterations << " iterations in " << executionTimes << " seconds (inertia " << inertia << ")." << std::endl;
+        std::cout << "Time to first iteration: " << firstIterationTime << " seconds (loading, pre-passes and seeding" << (options.pipeline ? ", with the seeding pipelined with the loading" : "") << ")." << std::endl;
+
+        if (options.precision != DOUBLE) {
+            // Compare with the double precision engine.
+            reportPrecision(std::move(initialCentroids), executionTimes);
+        }
+
+        if (kernel.engine == IVF) {
+            // Print the summary of the approximate assignment.
+            std::cout << "IVF: " << index.getLists() << " lists, " << index.getProbes() << " probed per point";
+            if (audit.samples > 0) {
+                std::cout << ", recall " << 100.0 * audit.hits / audit.samples << "% and inertia penalty " << 100.0 * (audit.approximateInertia - audit.exactInertia) / audit.exactInertia << "% against the exact assignment (" << audit.samples << " audited points)";
+            }
+            std::cout << "." << std::endl;
+        } else if (kernel.engine == PROJECTED && audit.samples > 0) {
+            // Print the summary of the shortlist of the sketch.
+            std::cout << "Projected: " << projection.getSketchDimensions() << " sketch dimensions, " << projection.getShortlist() << " shortlisted centroids per point, the shortlist missed the exact closest centroid for " << 100.0 * (audit.samples - audit.hits) / audit.samples << "% of the " << audit.samples << " audited points (inertia penalty " << 100.0 * (audit.approximateInertia - audit.exactInertia) / audit.exactInertia << "%)." << std::endl;
+        }
+
+        if ((options.evaluate || !options.output.empty()) && options.coresetSize > 0 && !options.coresetAssign && !options.coresetCompare) {
+            // Assign all the points to the centroids found on the coreset.
+            assign();
+        }
+
+        if (options.evaluate) {
+            // Evaluate the quality of the clustering.
+            reportEvaluation();
+        }
+
+        if (!options.output.empty() && options.sweepMaxK == 0) {
+            // Write the final labels and centroids.
+            writeOutput();
+        }
+
+        // Print the imbalance of the assignment phase.
+        pool.report();
+
+        // Print the summary of the iteration phases.
+        profiler.report(iterations, N, K, dimensions);
+
+        // Export the trace.
+        tracer.write();
+
+        // Save the results.
+        save_results(iterations, executionTimes, paths, "parallel", N, K, dimensions);
+    }
+
+    Model KMeans::fit() {
+        // Check the options and configure the threads and the kernel.
+        configure();
+
+        // Execute the algorithm without logging.
+        double executionTimes = 0, inertia = 0;
+        const int iterations = execute(FolderPaths(), false, executionTimes, inertia);
+
+        // Export the trace (if enabled).
+        tracer.write();
+
+        // The model of the largest K with the K sweep.
+        const Centroids& found = sweptCentroids ? *sweptCentroids : centroids;
+        return Model(found.copy(), options.metric, inertia, iterations, threads);
+    }
+
+
+    void KMeans::configure() {
+        if (options.metric != EUCLIDEAN && (options.kernel.engine == IVF || options.kernel.engine == PROJECTED || options.bisecting || options.coresetSize > 0)) {
+            throw std::runtime_error("ERROR: the approximate engines, the bisecting engine and the coreset only support the Euclidean metric");
+        }
+        if (options.precision != DOUBLE && (options.metric != EUCLIDEAN || options.kernel.engine == IVF || options.kernel.engine == PROJECTED || options.bisecting || options.coresetSize > 0)) {
+            throw std::runtime_error("ERROR: the reduced precisions only support the Euclidean metric with the naive and tiled engines");
+        }
+        if ((!options.checkpoint.empty() || options.resume) && (options.bisecting || options.coresetSize > 0)) {
+            throw std::runtime_error("ERROR: the checkpoints only support the flat iterations");
+        }
+        if (options.sweepMaxK > 0 && (options.bisecting || options.coresetSize > 0 || options.precision != DOUBLE || !options.checkpoint.empty() || options.resume)) {
+            throw std::runtime_error("ERROR: the K sweep only supports the flat iterations in double precision without checkpoints");
+        }
+        if (options.sweepMaxK > 0 && options.evaluate) {
+            throw std::runtime_error("ERROR: the K sweep reports its own quality score (use '--evaluate' without '--k_range')");
+        }
+        if (options.multiresFraction > 0 && (options.bisecting || options.coresetSize > 0 || options.sweepMaxK > 0 || options.resume)) {
+            throw std::runtime_error("ERROR: the multi-resolution solve does not support the bisecting engine, the coreset, the K sweep or resuming");
+        }
+        if (!options.initCentroids.empty() && options.bisecting) {
+            throw std::runtime_error("ERROR: the bisecting engine does not support initial centroids");
+        }
+        // Set the number of threads.
+        omp_set_num_threads(threads);
+
+        if (options.autotune) {
+            // Tune the assignment kernel for the workload (keeping the approximate engine if requested).
+            kernel = Autotuner(options.tuningCache).tune(*this);
+            if (options.kernel.engine == IVF || options.kernel.engine == PROJECTED) {
+                kernel.engine = options.kernel.engine;
+            }
+        }
+
+        if (options.precision != DOUBLE && kernel.pointTile > MAX_POINT_TILE) {
+            throw std::runtime_error("ERROR: the reduced precisions support tiles of at most " + std::to_string(MAX_POINT_TILE) + " points");
+        }
+
+        if (kernel.threads > 0) {
+            // Set the tuned number of threads.
+            omp_set_num_threads(kernel.threads);
+        }
+    }
+
+    int KMeans::execute(const FolderPaths& paths, const bool canPlot, double& executionTimes, double& inertia) {
+        if (options.precision != DOUBLE) {
+            // Quantize the coordinates of the points used by the iterations.
+            const double startTime = omp_get_wtime();
+            quantized = quantize(points, options.precision, omp_get_max_threads());
+            tracer.stage("quantization", startTime, omp_get_wtime());
+
+            std::cout << "Points stored as " << PRECISION_NAMES[options.precision] << ": " << quantized.memory() / 1048576.0 << " MB instead of " << (double) N * dimensions * sizeof(double) / 1048576.0 << " MB (" << (double) N * dimensions * sizeof(double) / quantized.memory() << "x less memory traffic in the iterations)." << std::endl;
+        }
+
+        // Time from the beginning of the construction (loading, pre-passes, seeding and quantization) to the first iteration.
+        const double startupTime = omp_get_wtime();
+        firstIterationTime = startupTime - constructionTime;
+        tracer.stage("startup", constructionTime, startupTime);
+
+        // Execute the algorithm (K sweep, multi-resolution, bisecting or on the coreset if required).
+        if (options.sweepMaxK > 0) {
+            return solveSweep(executionTimes, inertia);
+        } else if (options.multiresFraction > 0) {
+            return solveMultiresolution(paths, canPlot, executionTimes, inertia);
+        } else if (options.bisecting) {
+            return solveBisecting(executionTimes, inertia);
+        } else if (options.coresetSize > 0) {
+            return solveCoreset(executionTimes, inertia);
+        }
+
+        return solve(paths, canPlot, executionTimes, inertia);
+    }
+
+
+    int KMeans::solve(const FolderPaths& paths, const bool canPlot, double& executionTimes, double& inertia) {
+        // Variables for convergence.
+        int iterations = 0;
+        bool converged = false;
+
+        if (resumed.iterations > 0) {
+            // Continue the iterations of the checkpoint.
+            iterations = resumed.iterations;
+            converged = resumed.converged;
+            executionTimes += resumed.executionTimes;
+            inertia = resumed.inertia;
+            audit.samples = resumed.auditSamples;
+            audit.hits = resumed.auditHits;
+            audit.approximateInertia = resumed.auditApproximateInertia;
+            audit.exactInertia = resumed.auditExactInertia;
+            resumed = Checkpoint();
+        }
+
+        // Variable for logging.
+        std::string initMode = filePath.empty() ? "random" : "input";
+
         while (iterations < MAX_ITERATIONS && !converged) {
             // Start the timer.
             double startTime = omp_get_wtime();
 
             // Execute the iteration and check if the centroids have changed.
-            converged = KMeansIteration();
+            IterationMetrics metrics;
+            converged = KMeansIteration(metrics);
 
             // Stop the timer.
             double endTime = omp_get_wtime();
             executionTimes += endTime - startTime;
 
+            // Trace the iteration.
+            metrics.iteration = iterations;
+            metrics.time = endTime - startTime;
+            tracer.iteration(metrics, startTime);
+            inertia = metrics.inertia;
+
             if (canPlot) {
                 // Log the iteration.
                 log_data(iterations, paths, "parallel", "points", getCoordinates(points), getClustersIds(points));
@@ -63,30 +257,427 @@ namespace Parallel {
             }
 
             iterations++;
+
+            if (!options.checkpoint.empty() && (iterations % options.checkpointInterval == 0 || converged || iterations == MAX_ITERATIONS)) {
+                // Save the state of the iterations.
+                saveCheckpoint(iterations, converged, executionTimes, inertia);
+            }
         }
 
-        if(canPlot) {
-            // Convert to gif.
-            convert_gif(iterations, executionTimes, paths, "parallel");
+        return iterations;
+    }
+
+    int KMeans::solveCoreset(double& executionTimes, double& inertia) {
+        // Build the coreset.
+        double startTime = omp_get_wtime();
+        const int size = (int) std::min(N, (long long) options.coresetSize);
+        Points coreset = buildCoreset(points, size, omp_get_max_threads());
+        const double coresetTime = omp_get_wtime() - startTime;
+        tracer.stage("coreset", startTime, startTime + coresetTime);
+
+        std::cout << "Coreset: " << N << " points summarized into " << size << " weighted points (" << 100.0 * size / N << "%) in " << coresetTime << " seconds." << std::endl;
+
+        // Keep the initial centroids for the comparison with the full Lloyd.
+        Centroids initialCentroids = centroids.copy();
+
+        // Cluster the weighted coreset (from the same initial centroids).
+        KMeans coresetKMeans(std::move(coreset), centroids.copy(), threads, nestedOptions());
+        double solveTime = 0, coresetInertia = 0;
+        const int iterations = coresetKMeans.solve(FolderPaths(), false, solveTime, coresetInertia);
+        std::copy(coresetKMeans.centroids.coordinates, coresetKMeans.centroids.coordinates + K * dimensions, centroids.coordinates);
+
+        std::cout << "Coreset clustering: " << iterations << " iterations in " << solveTime << " seconds (coreset inertia " << coresetInertia << ")." << std::endl;
+        executionTimes = coresetTime + solveTime;
+        inertia = coresetInertia;
+
+        if (options.coresetAssign || options.coresetCompare) {
+            // Final assignment pass over all the points.
+            startTime = omp_get_wtime();
+            inertia = assign();
+            const double assignTime = omp_get_wtime() - startTime;
+            tracer.stage("assignment", startTime, startTime + assignTime);
+            executionTimes += assignTime;
+
+            std::cout << "Full-data assignment pass in " << assignTime << " seconds (inertia " << inertia << ")." << std::endl;
         }
 
-        std::cout << "Converged after " << iterations << " iterations in " << executionTimes << " seconds." << std::endl;
+        if (options.coresetCompare) {
+            // Full Lloyd on the same points from the same initial centroids.
+            Points copy = points.copy();
+            std::fill(copy.clustersIds, copy.clustersIds + N, -1);
 
-        // Save the results.
-        save_results(iterations, executionTimes, paths, "parallel", N, K, dimensions);
+            KMeans fullKMeans(std::move(copy), std::move(initialCentroids), threads, nestedOptions());
+            double fullTime = 0, fullInertia = 0;
+            const int fullIterations = fullKMeans.solve(FolderPaths(), false, fullTime, fullInertia);
+
+            std::cout << "Full Lloyd: " << fullIterations << " iterations in " << fullTime << " seconds (inertia " << fullInertia << "). Time saved: " << fullTime - executionTimes << " seconds, inertia gap: " << 100.0 * (inertia - fullInertia) / fullInertia << "%." << std::endl;
+        }
+
+        return iterations;
+    }
+
+    int KMeans::solveBisecting(double& executionTimes, double& inertia) {
+        // Find the clusters by recursive splits.
+        const double startTime = omp_get_wtime();
+        inertia = bisect(points, centroids, options.bisection, omp_get_max_threads());
+        const double bisectingTime = omp_get_wtime() - startTime;
+        tracer.stage("bisecting", startTime, startTime + bisectingTime);
+        executionTimes += bisectingTime;
+
+        std::cout << "Bisecting: " << K << " clusters found by splitting the " << (options.bisection == LARGEST ? "largest" : "highest-SSE") << " clusters in " << bisectingTime << " seconds (inertia " << inertia << ")." << std::endl;
+
+        if (!options.refine) {
+            return 0;
+        }
+
+        // Refine the clusters with the flat iterations.
+        return solve(FolderPaths(), false, executionTimes, inertia);
+    }
+
+    int KMeans::solveMultiresolution(const FolderPaths& paths, const bool canPlot, double& executionTimes, double& inertia) {
+        int stage = 0;
+
+        for(double fraction = options.multiresFraction; fraction < 1; fraction *= MULTIRES_FACTOR) {
+            if (fraction * N < (double) MULTIRES_CLUSTER_POINTS * K) {
+                // Too few points per cluster in the subsample.
+                continue;
+            }
+
+            // Draw the subsample of the stage.
+            const double startTime = omp_get_wtime();
+            Points sample = samplePoints(points, fraction, SEED + stage, omp_get_max_threads());
+            const long long size = sample.size;
+
+            // Iterate on the subsample from the current centroids.
+            KMeans stageKMeans(std::move(sample), centroids.copy(), threads, nestedOptions());
+            double solveTime = 0, stageInertia = 0;
+            const int iterations = stageKMeans.solve(FolderPaths(), false, solveTime, stageInertia);
+            std::copy(stageKMeans.centroids.coordinates, stageKMeans.centroids.coordinates + K * dimensions, centroids.coordinates);
+
+            const double endTime = omp_get_wtime();
+            executionTimes += endTime - startTime;
+            tracer.stage("stage " + std::to_string(stage), startTime, endTime);
+
+            std::cout << "Stage " << stage << ": " << iterations << " iterations on " << size << " points (" << 100.0 * fraction << "%) in " << endTime - startTime << " seconds (sample inertia " << stageInertia << ")." << std::endl;
+            stage++;
+        }
+
+        // Final stage on all the points.
+        const double startTime = omp_get_wtime();
+        const int iterations = solve(paths, canPlot, executionTimes, inertia);
+
+        std::cout << "Stage " << stage << ": " << iterations << " iterations on all the " << N << " points in " << omp_get_wtime() - startTime << " seconds." << std::endl;
+
+        return iterations;
+    }
+
+    int KMeans::solveSweep(double& executionTimes, double& inertia) {
+        const int step = options.sweepStep;
+
+        // Weighted total sum of squares of the points (for the Calinski-Harabasz score, with the Euclidean metric).
+        std::vector<double> means(dimensions, 0);
+        double totalWeight = 0, totalSS = 0;
+        #pragma omp parallel for schedule(static) reduction(+:totalWeight)
+        for(long long i = 0; i < N; i++) {
+            totalWeight += points.weights[i];
+        }
+        for(int dim = 0; dim < dimensions; dim++) {
+            double sum = 0, squares = 0;
+            #pragma omp parallel for schedule(static) reduction(+:sum, squares)
+            for(long long i = 0; i < N; i++) {
+                sum += points.weights[i] * points.coordinates[i + N * dim];
+                squares += points.weights[i] * points.coordinates[i + N * dim] * points.coordinates[i + N * dim];
+            }
+            means[dim] = sum / totalWeight;
+            totalSS += squares - sum * means[dim];
+        }
+
+        std::cout << "Sweeping K from " << K << " to " << options.sweepMaxK << " by " << step << " (each K warm-started from the previous solution)." << std::endl;
+
+        // Report of the sweep (one row per K).
+        std::ostringstream report;
+        report << "k,iterations,inertia,calinski_harabasz,time" << std::endl;
+
+        // Chain of executions (the points are moved along the chain and taken back at the end).
+        KMeans* current = this;
+        std::unique_ptr<KMeans> link;
+        int totalIterations = 0;
+
+        for(int k = K; k <= options.sweepMaxK; k += step) {
+            const double startTime = omp_get_wtime();
+
+            if (k > K) {
+                // Grow the centroids of the previous K and move the points to the next execution.
+                Centroids grown = options.metric == COSINE ? current->growCentroids<Cosine>(step) : options.metric == MANHATTAN ? current->growCentroids<Manhattan>(step) : current->growCentroids<SquaredEuclidean>(step);
+                link.reset(new KMeans(std::move(current->points), std::move(grown), threads, nestedOptions()));
+                current = link.get();
+            }
+
+            double solveTime = 0;
+            const int iterations = current->solve(FolderPaths(), false, solveTime, inertia);
+            totalIterations += iterations;
+
+            const double endTime = omp_get_wtime();
+            executionTimes += endTime - startTime;
+            tracer.stage("k=" + std::to_string(k), startTime, endTime);
+
+            // Ratio of the between and within-cluster dispersions (higher is better).
+            const double score = options.metric == EUCLIDEAN && k > 1 && totalWeight > k ? ((totalSS - inertia) / (k - 1)) / (inertia / (totalWeight - k)) : 0;
+
+            std::cout << "K=" << k << ": " << iterations << " iterations in " << endTime - startTime << " seconds, inertia " << inertia;
+            if (score > 0) {
+                std::cout << ", Calinski-Harabasz " << score;
+            }
+            std::cout << "." << std::endl;
+            report << k << "," << iterations << "," << inertia << "," << score << "," << endTime - startTime << std::endl;
+        }
+
+        if (current != this) {
+            // Take back the points (with the assignment of the largest K) and keep the centroids of the largest K.
+            points.swap(current->points);
+            sweptCentroids.reset(new Centroids(std::move(current->centroids)));
+        }
+
+        if (!options.output.empty()) {
+            // Write the report of the sweep.
+            std::ofstream file(options.output + ".sweep.csv");
+            file << report.str();
+        }
+
+        return totalIterations;
+    }
+
+    template <typename Metric>
+    Centroids KMeans::growCentroids(const int added) {
+        const int grownK = K + added;
+        Centroids grown(grownK, dimensions, new double[grownK * dimensions], new int[grownK]);
+
+        for(int j = 0; j < K; j++) {
+            for(int dim = 0; dim < dimensions; dim++) {
+                grown.coordinates[j + grownK * dim] = centroids.coordinates[j + K * dim];
+            }
+            grown.clustersIds[j] = j;
+        }
+
+        // Weighted distance of each point to its centroid.
+        std::vector<double> weights(N);
+        #pragma omp parallel for schedule(static)
+        for(long long i = 0; i < N; i++) {
+            weights[i] = points.weights[i] * std::max(0.0, distance<Metric>(i, points.clustersIds[i]));
+        }
+
+        std::default_random_engine generator(SEED + grownK); // Random number engine (with seed for reproducibility).
+
+        for(int j = K; j < grownK; j++) {
+            double total = 0;
+            #pragma omp parallel for schedule(static) reduction(+:total)
+            for(long long i = 0; i < N; i++) {
+                total += weights[i];
+            }
+
+            // Draw a point with a probability proportional to its weight (uniformly if all the points are on a centroid).
+            long long chosen = std::uniform_int_distribution<long long>(0, N - 1)(generator);
+            if (total > 0) {
+                double target = std::uniform_real_distribution<double>(0, total)(generator);
+                for(long long i = 0; i < N; i++) {
+                    if (weights[i] > 0) {
+                        chosen = i;
+                        target -= weights[i];
+                        if (target < 0) break;
+                    }
+                }
+            }
+
+            for(int dim = 0; dim < dimensions; dim++) {
+                grown.coordinates[j + grownK * dim] = points.coordinates[chosen + N * dim];
+            }
+            grown.clustersIds[j] = j;
+
+            // Update the weights with the distances to the added centroid.
+            #pragma omp parallel for schedule(static)
+            for(long long i = 0; i < N; i++) {
+                double sum = 0;
+                for(int dim = 0; dim < dimensions; dim++) {
+                    sum += Metric::term(points.coordinates[i + N * dim], points.coordinates[chosen + N * dim]);
+                }
+                weights[i] = std::min(weights[i], points.weights[i] * std::max(0.0, Metric::finish(sum)));
+            }
+        }
+
+        return grown;
+    }
+
+    double KMeans::assign() {
+        const int pointTile = kernel.pointTile; // Number of points of a tile.
+        const long long numTiles = (N + pointTile - 1) / pointTile; // Number of tiles.
+
+        // Inertia of each tile (summed in a fixed order).
+        std::vector<double> tilesInertia(numTiles, 0);
+
+        #pragma omp parallel default(none) shared(pointTile, numTiles, tilesInertia)
+        {
+            // Buffers of the thread for the closest centroids of a tile of points.
+            std::vector<int> minClustersIds(pointTile);
+            std::vector<double> minDistances(pointTile);
+            std::vector<double> distances(kernel.engine == TILED || quantized.precision != DOUBLE ? pointTile * kernel.centroidTile : 0);
+
+            if (kernel.engine == IVF) {
+                // Build the index over the current centroids.
+                index.build(centroids);
+            } else if (kernel.engine == PROJECTED) {
+                // Project the current centroids (and the points the first time).
+                projection.build(points, centroids);
+            }
+
+            #pragma omp for schedule(static)
+            for(long long tile = 0; tile < numTiles; tile++) {
+                const long long begin = tile * pointTile; // Identifier of the first point of the tile.
+                const long long end = std::min(N, begin + pointTile); // Identifier after the last point of the tile.
+
+                assignTile(begin, end, minClustersIds.data(), minDistances.data(), distances.data());
+
+                for(long long i = begin; i < end; i++) {
+                    // Update the identifier of the cluster.
+                    points.clustersIds[i] = minClustersIds[i - begin];
+
+                    // Accumulate the weighted squared distance to the closest centroid.
+                    tilesInertia[tile] += points.weights[i] * minDistances[i - begin];
+                }
+            }
+        }
+
+        double inertia = 0;
+        for(long long tile = 0; tile < numTiles; tile++) {
+            inertia += tilesInertia[tile];
+        }
+
+        return inertia;
+    }
+
+    void KMeans::normalize(Points& data) {
+        const long long size = data.size;
+
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for(long long i = 0; i < size; i++) {
+            double norm = 0;
+            for(int dim = 0; dim < dimensions; dim++) {
+                norm += data.coordinates[i + size * dim] * data.coordinates[i + size * dim];
+            }
+            norm = sqrt(norm);
+
+            for(int dim = 0; dim < dimensions && norm > 0; dim++) {
+                data.coordinates[i + size * dim] /= norm;
+            }
+        }
+    }
+
+    void KMeans::updateMedians() {
+        // Group the points by cluster (counting sort, stable in the identifiers).
+        #pragma omp single
+        {
+            clustersOffsets.assign(K + 1, 0);
+            clustersPoints.resize(N);
+
+            for(long long i = 0; i < N; i++) {
+                clustersOffsets[points.clustersIds[i] + 1]++;
+            }
+            for(int j = 0; j < K; j++) {
+                clustersOffsets[j + 1] += clustersOffsets[j];
+            }
+
+            std::vector<long long> positions(clustersOffsets.begin(), clustersOffsets.end() - 1);
+            for(long long i = 0; i < N; i++) {
+                clustersPoints[positions[points.clustersIds[i]]++] = i;
+            }
+        }
+
+        // Values and weights of the points of a cluster in a dimension (buffer of the thread).
+        std::vector<std::pair<double, double>> values;
+
+        // Weighted median of each cluster in each dimension (clusters of varying sizes scheduled dynamically).
+        #pragma omp for schedule(dynamic) nowait
+        for(int e = 0; e < K * dimensions; e++) {
+            const int j = e % K, dim = e / K;
+            const long long first = clustersOffsets[j], last = clustersOffsets[j + 1];
+
+            // Empty clusters keep their centroid.
+            if (first == last) {
+                continue;
+            }
+
+            values.clear();
+            double totalWeight = 0;
+            for(long long p = first; p < last; p++) {
+                const long long i = clustersPoints[p];
+                values.emplace_back(points.coordinates[i + N * dim], points.weights[i]);
+                totalWeight += points.weights[i];
+            }
+            std::sort(values.begin(), values.end());
+
+            // First value whose cumulative weight reaches half of the total weight.
+            double cumulative = 0;
+            for(const std::pair<double, double>& value : values) {
+                cumulative += value.second;
+                if (cumulative >= totalWeight / 2) {
+                    centroids.coordinates[j + K * dim] = value.first;
+                    break;
+                }
+            }
+        }
     }
 
+    void KMeans::reportPrecision(Centroids&& initialCentroids, const double executionTimes) {
+        // Inertia of the found centroids with the double precision coordinates.
+        Points evaluatedPoints = points.copy();
+        KMeans evaluation(std::move(evaluatedPoints), centroids.copy(), threads, nestedOptions());
+        const double evaluatedInertia = evaluation.assign();
+
+        // Double precision engine from the same initial centroids.
+        Points referencePoints = points.copy();
+        std::fill(referencePoints.clustersIds, referencePoints.clustersIds + N, -1);
+        KMeans reference(std::move(referencePoints), std::move(initialCentroids), threads, nestedOptions());
+        double referenceTime = 0, referenceInertia = 0;
+        const int referenceIterations = reference.solve(FolderPaths(), false, referenceTime, referenceInertia);
+
+        std::cout << "Precision " << PRECISION_NAMES[quantized.precision] << ": inertia " << evaluatedInertia << " in double precision, against " << referenceInertia << " for the double precision engine (" << referenceIterations << " iterations in " << referenceTime << " seconds): deviation " << 100.0 * (evaluatedInertia - referenceInertia) / referenceInertia << "%, speedup " << referenceTime / executionTimes << "x." << std::endl;
+    }
+
+    Options KMeans::nestedOptions() const {
+        // Same kernel and reduction, without the instrumentation and the pre-passes.
+        Options nested = options;
+        nested.kernel = kernel;
+        nested.autotune = false;
+        nested.dedupe = false;
+        nested.pipeline = false;
+        nested.profile = false;
+        nested.trace = "";
+        nested.coresetSize = 0;
+        nested.bisecting = false;
+        nested.precision = DOUBLE;
+        nested.checkpoint = "";
+        nested.resume = false;
+        nested.initCentroids = "";
+        nested.output = "";
+        nested.sweepMaxK = 0;
+        nested.multiresFraction = 0;
+
+        return nested;
+    }
+
+
+    Points KMeans::initializeRandomPoints() {
+        const double startTime = omp_get_wtime();
 
-    const Points KMeans::initializeRandomPoints() {
         // Uniform distribution between 0 and MAX_RANGE.
         std::default_random_engine generator(SEED); // Random number engine (with seed for reproducibility).
         std::uniform_real_distribution<double> uniformDistribution(0, MAX_RANGE); // Uniform distribution.
 
         // Initialize Point structure.
-        Points points(N, dimensions, new double[N * dimensions], new int[N], new int[N]);
+        Points points(N, dimensions, new double[N * dimensions], new long long[N], new int[N], new double[N]);
+        points.firstTouch(threads);
 
         // Generate N random points from the uniform distribution.
-        for(int i = 0; i < N; i++) {
+        for(long long i = 0; i < N; i++) {
             for(int dim = 0; dim < dimensions; dim++) {
                 // Generate a random coordinate.
                 points.coordinates[i + N * dim] = uniformDistribution(generator);
@@ -99,83 +690,158 @@ namespace Parallel {
             points.clustersIds[i] = -1;
         }
 
+        tracer.stage("generation", startTime, omp_get_wtime());
+
         return points;
     }
 
-    const Points KMeans::initializeInputPoints() {
-        // File stream.
-        std::ifstream file;
-        std::string line, word;
+    Points KMeans::initializeInputPoints() {
+        const double startTime = omp_get_wtime();
 
-        // Open the file.
-        file.open(filePath, std::ios::in);
+        // Load the points (the last column is the weight of weighted points), sampling the seeds from the chunks as they are parsed.
+        Points points = loadPoints(filePath, options.weighted, threads, options.pipeline ? &reservoir : nullptr);
 
-        if (!file.is_open()) {
-            throw std::runtime_error("ERROR: couldn't open file");
-        }
+        // Set N and dimensions based on the file content.
+        N = points.size; // Number of points.
+        dimensions = points.dimensions; // Number of dimensions.
 
-        // Count the number of lines and columns in the file.
-        int numColumns = 0;
-        std::getline(file, line);
-        std::stringstream ss(line);
-        while (std::getline(ss, line, ',')) numColumns++;
-        
-        // Count the number of lines in the file.
-        int numLines = 1;
-        while (std::getline(file, line)) numLines++;
+        tracer.stage("loading", startTime, omp_get_wtime());
 
-        // Set N and dimensions based on the file content.
-        N = numLines; // Number of points.
-        dimensions = numColumns; // Number of dimensions.
+        return points;
+    }
 
+    Points KMeans::preprocessPoints(Points&& loadedPoints) {
+        // Number of original points.
+        rows = loadedPoints.size;
 
-        // Reopen the file for reading from the beginning.
-        file.clear();
-        file.seekg(0, std::ios::beg);
+        if (options.metric == COSINE) {
+            // Normalize the points to unit vectors (before the deduplication, so that the points with the same direction are collapsed).
+            normalize(loadedPoints);
+        }
 
-        // Initialize points structure.
-        Points points(N, dimensions, new double[N * dimensions], new int[N], new int[N]);
+        if (options.dedupe) {
+            const double startTime = omp_get_wtime();
 
-        int i = 0;
-        while (getline(file, line)) {
-            std::stringstream str(line);
-            int dim = 0;
-            while (getline(str, word, ',')) {
-                // Set the coordinate to the point.
-                points.coordinates[i + N * dim] = std::stod(word);
+            // Collapse the identical points into weighted points.
+            Points uniquePoints = deduplicate(loadedPoints, rowToPoint, threads);
+            N = uniquePoints.size;
 
-                // Increment the dimension.
-                dim++;
-            }
+            tracer.stage("deduplication", startTime, omp_get_wtime());
 
-            // Set the identifier of the point.
-            points.pointsIds[i] = i;
+            return reorderPoints(std::move(uniquePoints));
+        }
 
-            // Set the identifier of the cluster.
-            points.clustersIds[i] = -1;
+        return reorderPoints(std::move(loadedPoints));
+    }
 
-            // Increment the point.
-            i++;
+    Points KMeans::reorderPoints(Points&& unorderedPoints) {
+        if (options.order == INPUT_ORDER) {
+            return std::move(unorderedPoints);
         }
 
-        return points;
+        const double startTime = omp_get_wtime();
+
+        // Sort the points by their key (the map of the original points is composed with the permutation).
+        Points orderedPoints = reorder(unorderedPoints, options.order, rowToPoint, threads);
+
+        const double endTime = omp_get_wtime();
+        tracer.stage("reordering", startTime, endTime);
+
+        std::cout << "Reordered " << N << " points by " << ORDER_NAMES[options.order] << " key in " << endTime - startTime << " seconds." << std::endl;
+
+        return orderedPoints;
     }
 
     const Centroids KMeans::initializeCentroids() {
-        if (K > N) {
+        if (K > rows) {
             throw std::runtime_error("ERROR: K cannot be greater than N!");
         }
 
-        // Uniform distribution between 0 and N-1 for selecting unique indices.
+        const double startTime = omp_get_wtime();
+
+        if (options.resume) {
+            // Resume from the centroids of the checkpoint (if any).
+            Centroids centroids(K, dimensions, new double[K * dimensions], new int[K]);
+
+            if (readCheckpoint(options.checkpoint, resumed, centroids)) {
+                pointsFingerprint = fingerprint(points, threads);
+                if (resumed.rows != rows || resumed.fingerprint != pointsFingerprint || resumed.metric != options.metric) {
+                    throw std::runtime_error("ERROR: the checkpoint " + options.checkpoint + " does not match the points or the metric");
+                }
+
+                for(int j = 0; j < K; j++) {
+                    centroids.clustersIds[j] = j;
+                }
+
+                tracer.stage("seeding", startTime, omp_get_wtime());
+                std::cout << "Resumed from the checkpoint " << options.checkpoint << " after " << resumed.iterations << " iterations." << std::endl;
+
+                return centroids;
+            }
+
+            std::cout << "No checkpoint " << options.checkpoint << " to resume from, starting from the initial centroids." << std::endl;
+        }
+
+        if (!options.initCentroids.empty()) {
+            // Warm start from the centroids of a previous model.
+            Centroids centroids = loadCentroids(options.initCentroids, K, dimensions);
+
+            if (options.metric == COSINE) {
+                // Normalize the centroids to unit vectors (spherical k-means).
+                for(int j = 0; j < K; j++) {
+                    double norm = 0;
+                    for(int dim = 0; dim < dimensions; dim++) {
+                        norm += centroids.coordinates[j + K * dim] * centroids.coordinates[j + K * dim];
+                    }
+                    norm = sqrt(norm);
+
+                    for(int dim = 0; dim < dimensions && norm > 0; dim++) {
+                        centroids.coordinates[j + K * dim] /= norm;
+                    }
+                }
+            }
+
+            tracer.stage("seeding", startTime, omp_get_wtime());
+            std::cout << "Initialized the centroids from " << options.initCentroids << "." << std::endl;
+
+            return centroids;
+        }
+
+        // Rows sampled from the input file while it was loaded (if pipelined).
+        std::vector<std::vector<double>> sampledRows = reservoir.rows();
+
+        if (sampledRows.size() == (size_t) K) {
+            // Initialize the centroids from the sampled rows (normalized with the points for the cosine metric).
+            Centroids centroids(K, dimensions, new double[K * dimensions], new int[K]);
+
+            for(int j = 0; j < K; j++) {
+                double norm = 0;
+                for(int dim = 0; dim < dimensions; dim++) {
+                    norm += sampledRows[j][dim] * sampledRows[j][dim];
+                }
+                norm = options.metric == COSINE && norm > 0 ? sqrt(norm) : 1;
+
+                for(int dim = 0; dim < dimensions; dim++) {
+                    centroids.coordinates[j + K * dim] = sampledRows[j][dim] / norm;
+                }
+                centroids.clustersIds[j] = j;
+            }
+
+            tracer.stage("seeding", startTime, omp_get_wtime());
+
+            return centroids;
+        }
+
+        // Uniform distribution between 0 and N-1 for selecting unique indices (of the original points, so that the pre-passes do not change the seeding).
         std::default_random_engine generator(SEED); // Random number engine (with seed for reproducibility).
-        std::uniform_int_distribution<int> intDistribution(0, N - 1); // Uniform distribution.
+        std::uniform_int_distribution<long long> intDistribution(0, rows - 1); // Uniform distribution.
 
         // Set of random indices.
-        std::set<int> randomIndices;
+        std::set<long long> randomIndices;
 
         // Generate K random indices.
         while (randomIndices.size() < K) {
-            int randomIndex = intDistribution(generator);
+            long long randomIndex = intDistribution(generator);
 
             // Check if the random index is unique.
             if (randomIndices.find(randomIndex) == randomIndices.end()) {
@@ -189,8 +855,11 @@ namespace Parallel {
 
         // Generate K random centroids from points.
         for(int j = 0; j < K; j++) {
-            // Get the j-th random index.
-            int randomIndex = *std::next(randomIndices.begin(), j);
+            // Get the j-th random index (mapped to the points).
+            long long randomIndex = *std::next(randomIndices.begin(), j);
+            if (!rowToPoint.empty()) {
+                randomIndex = rowToPoint[randomIndex];
+            }
 
             for(int dim = 0; dim < dimensions; dim++) {
                 // Set the coordinates of the centroid.
@@ -201,37 +870,31 @@ namespace Parallel {
             centroids.clustersIds[j] = j;
         }
 
+        tracer.stage("seeding", startTime, omp_get_wtime());
+
         return centroids;
     }
 
 
-    const double KMeans::distance(const int pointId, const int centroidId) {
+    template <typename Metric>
+    double KMeans::distance(const long long pointId, const int centroidId) {
         double sum = 0;
         #pragma omp simd reduction(+:sum)
         for (int dim = 0; dim < dimensions; dim++) {
-            sum += (centroids.coordinates[centroidId + K * dim] - points.coordinates[pointId + N * dim]) * (centroids.coordinates[centroidId + K * dim] - points.coordinates[pointId + N * dim]);
+            sum += Metric::term(points.coordinates[pointId + N * dim], centroids.coordinates[centroidId + K * dim]);
         }
         
-        return sqrt(sum);
+        return Metric::finish(sum);
     }
 
-
-    bool KMeans::KMeansIteration() {
-        // Variables for the mean of the points in each cluster.
-        double clustersSum[K * dimensions] = {0}; // Sum of coordinates of points in each cluster.
-        int clustersSize[K] = {0}; // Number of points in each cluster.
-
-        // Convergence flag. Assume convergence at the beginning.
-        bool converged = true;
-
-        // Assign each point to the closest centroid.
-        #pragma omp parallel for schedule(static) default(none) shared(points, centroids, clustersSum, clustersSize) 
-        for(int i = 0; i < N; i++) {
+    template <typename Metric>
+    void KMeans::assignNaive(const long long begin, const long long end, int* minClustersIds, double* minDistances) {
+        for(long long i = begin; i < end; i++) {
             double minDist = DBL_MAX; // Distance to the closest cluster (initialized to infinity).
             int minClusterId = -1; // Id of the closest cluster (initialize to -1).
 
             for(int j = 0; j < K; j++) {
-                double dist = distance(i, j);
+                double dist = distance<Metric>(i, j);
 
                 if(dist < minDist) {
                     minDist = dist;
@@ -239,40 +902,465 @@ namespace Parallel {
                 }
             }
 
-            // Update the identifier of the cluster.
-            points.clustersIds[i] = minClusterId;
+            minClustersIds[i - begin] = minClusterId;
+            minDistances[i - begin] = minDist;
+        }
+    }
+
+    template <typename Metric>
+    void KMeans::assignTiled(const long long begin, const long long end, int* minClustersIds, double* minDistances, double* distances) {
+        const int size = (int) (end - begin); // Number of points of the tile.
+        const int centroidTile = kernel.centroidTile; // Number of centroids of a tile.
+
+        for(int p = 0; p < size; p++) {
+            minDistances[p] = DBL_MAX;
+            minClustersIds[p] = -1;
+        }
+
+        for(int first = 0; first < K; first += centroidTile) {
+            const int last = std::min(K, first + centroidTile); // Identifier after the last centroid of the tile.
+
+            // Reset the distances of the tile.
+            for(int c = 0; c < (last - first) * size; c++) {
+                distances[c] = 0;
+            }
 
+            // Accumulate the terms of the distances dimension by dimension (contiguous in the SoA coordinates).
             for(int dim = 0; dim < dimensions; dim++) {
-                #pragma omp atomic
-                // Sum the coordinates of the point assigned to the cluster.
-                clustersSum[minClusterId + K * dim] += points.coordinates[i + N * dim];
+                const double* coordinates = &points.coordinates[begin + N * dim];
+
+                for(int j = first; j < last; j++) {
+                    const double centroidCoordinate = centroids.coordinates[j + K * dim];
+                    double* row = &distances[(j - first) * size];
+
+                    #pragma omp simd
+                    for(int p = 0; p < size; p++) {
+                        row[p] += Metric::term(coordinates[p], centroidCoordinate);
+                    }
+                }
+            }
+
+            // Update the closest centroids of the tile points.
+            for(int j = first; j < last; j++) {
+                const double* row = &distances[(j - first) * size];
+
+                for(int p = 0; p < size; p++) {
+                    const double dist = Metric::finish(row[p]);
+                    if(dist < minDistances[p]) {
+                        minDistances[p] = dist;
+                        minClustersIds[p] = j;
+                    }
+                }
             }
-                    
-            #pragma omp atomic
-            // Increment the size of the cluster.
-            clustersSize[minClusterId]++;
         }
+    }
+
+
+    template <typename Storage>
+    void KMeans::assignQuantized(const long long begin, const long long end, int* minClustersIds, double* minDistances, double* distances) {
+        const int size = (int) (end - begin); // Number of points of the tile.
+        const int centroidTile = kernel.centroidTile; // Number of centroids of a tile.
+        const typename Storage::Type* values = quantized.data<Storage>();
+
+        for(int p = 0; p < size; p++) {
+            minDistances[p] = DBL_MAX;
+            minClustersIds[p] = -1;
+        }
+
+        for(int first = 0; first < K; first += centroidTile) {
+            const int last = std::min(K, first + centroidTile); // Identifier after the last centroid of the tile.
 
-        // Update the centroids.
-        for(int j = 0; j < K; j++){
-            // Temporary array for the previous coordinates of the centroid.
-            double tmpCoordinates[dimensions] = {0};
+            // Reset the distances of the tile.
+            for(int c = 0; c < (last - first) * size; c++) {
+                distances[c] = 0;
+            }
 
-            // Update the centroid of the cluster.
+            // Accumulate the squared distances dimension by dimension, decoding the coordinates of the tile to float once.
             for(int dim = 0; dim < dimensions; dim++) {
-                // Save the previous centroid coordinates.
-                tmpCoordinates[dim] = centroids.coordinates[j + K * dim];
+                const typename Storage::Type* column = &values[begin + (size_t) N * dim];
+                const float scale = quantized.scales[dim], offset = quantized.offsets[dim];
 
-                // Calculate the new centroid coordinates.
-                centroids.coordinates[j + K * dim] = clustersSum[j + K * dim] / clustersSize[j];
+                alignas(64) float decoded[MAX_POINT_TILE];
+                #pragma omp simd
+                for(int p = 0; p < size; p++) {
+                    decoded[p] = Storage::decode(column[p], scale, offset);
+                }
+
+                for(int j = first; j < last; j++) {
+                    const float centroidCoordinate = (float) centroids.coordinates[j + K * dim];
+                    double* row = &distances[(j - first) * size];
+
+                    #pragma omp simd
+                    for(int p = 0; p < size; p++) {
+                        const float difference = decoded[p] - centroidCoordinate;
+                        row[p] += difference * difference;
+                    }
+                }
+            }
+
+            // Update the closest centroids of the tile points.
+            for(int j = first; j < last; j++) {
+                const double* row = &distances[(j - first) * size];
 
-                // Check for convergence.
-                if (fabs(tmpCoordinates[dim] - centroids.coordinates[j + K * dim]) > EPSILON) {
-                    converged = false;
+                for(int p = 0; p < size; p++) {
+                    if(row[p] < minDistances[p]) {
+                        minDistances[p] = row[p];
+                        minClustersIds[p] = j;
+                    }
                 }
             }
         }
-        
+    }
+
+
+    void KMeans::assignIndexed(const long long begin, const long long end, int* minClustersIds, double* minDistances) {
+        for(long long i = begin; i < end; i++) {
+            index.search(&points.coordinates[i], N, minClustersIds[i - begin], minDistances[i - begin]);
+        }
+    }
+
+    void KMeans::assignProjected(const long long begin, const long long end, int* minClustersIds, double* minDistances) {
+        for(long long i = begin; i < end; i++) {
+            projection.search(points, centroids, i, minClustersIds[i - begin], minDistances[i - begin]);
+        }
+    }
+
+    void KMeans::assignTile(const long long begin, const long long end, int* minClustersIds, double* minDistances, double* distances) {
+        // The engine and the metric are resolved once per tile, so that each kernel is specialized for its metric.
+        if (quantized.precision == BF16) {
+            assignQuantized<BF16Storage>(begin, end, minClustersIds, minDistances, distances);
+        } else if (quantized.precision == FP16) {
+            assignQuantized<FP16Storage>(begin, end, minClustersIds, minDistances, distances);
+        } else if (quantized.precision == INT8) {
+            assignQuantized<INT8Storage>(begin, end, minClustersIds, minDistances, distances);
+        } else if (kernel.engine == TILED) {
+            if (options.metric == COSINE) {
+                assignTiled<Cosine>(begin, end, minClustersIds, minDistances, distances);
+            } else if (options.metric == MANHATTAN) {
+                assignTiled<Manhattan>(begin, end, minClustersIds, minDistances, distances);
+            } else {
+                assignTiled<SquaredEuclidean>(begin, end, minClustersIds, minDistances, distances);
+            }
+        } else if (kernel.engine == IVF) {
+            assignIndexed(begin, end, minClustersIds, minDistances);
+        } else if (kernel.engine == PROJECTED) {
+            assignProjected(begin, end, minClustersIds, minDistances);
+        } else {
+            if (options.metric == COSINE) {
+                assignNaive<Cosine>(begin, end, minClustersIds, minDistances);
+            } else if (options.metric == MANHATTAN) {
+                assignNaive<Manhattan>(begin, end, minClustersIds, minDistances);
+            } else {
+                assignNaive<SquaredEuclidean>(begin, end, minClustersIds, minDistances);
+            }
+        }
+    }
+
+
+    void KMeans::assignBlock(const long long begin, const long long end, double* sums, double* sizes, int* minClustersIds, double* minDistances, double* distances, long long& moved, double& inertia) {
+        const int pointTile = kernel.pointTile; // Number of points of a tile.
+
+        for(long long tileBegin = begin; tileBegin < end; tileBegin += pointTile) {
+            const long long tileEnd = std::min(end, tileBegin + pointTile); // Identifier after the last point of the tile.
+
+            assignTile(tileBegin, tileEnd, minClustersIds, minDistances, distances);
+
+            for(long long i = tileBegin; i < tileEnd; i++) {
+                const int minClusterId = minClustersIds[i - tileBegin]; // Id of the closest cluster.
+                const double weight = points.weights[i]; // Weight of the point.
+
+                // Count the points that changed cluster.
+                if (points.clustersIds[i] != minClusterId) {
+                    moved++;
+                }
+
+                // Accumulate the weighted squared distance to the closest centroid.
+                inertia += weight * minDistances[i - tileBegin];
+
+                // Update the identifier of the cluster.
+                points.clustersIds[i] = minClusterId;
+
+                for(int dim = 0; dim < dimensions && quantized.precision == DOUBLE; dim++) {
+                    // Sum the weighted coordinates of the point assigned to the cluster.
+                    sums[minClusterId + K * dim] += weight * points.coordinates[i + N * dim];
+                }
+
+                // Increment the weighted size of the cluster.
+                sizes[minClusterId] += weight;
+            }
+
+            // Sum the weighted decoded coordinates of the quantized points.
+            if (quantized.precision == BF16) {
+                accumulateQuantized<BF16Storage>(tileBegin, tileEnd, minClustersIds, sums);
+            } else if (quantized.precision == FP16) {
+                accumulateQuantized<FP16Storage>(tileBegin, tileEnd, minClustersIds, sums);
+            } else if (quantized.precision == INT8) {
+                accumulateQuantized<INT8Storage>(tileBegin, tileEnd, minClustersIds, sums);
+            }
+        }
+    }
+
+    template <typename Storage>
+    void KMeans::accumulateQuantized(const long long begin, const long long end, const int* minClustersIds, double* sums) {
+        const typename Storage::Type* values = quantized.data<Storage>();
+
+        for(int dim = 0; dim < dimensions; dim++) {
+            const typename Storage::Type* column = &values[begin + (size_t) N * dim];
+            const float scale = quantized.scales[dim], offset = quantized.offsets[dim];
+
+            for(long long i = begin; i < end; i++) {
+                sums[minClustersIds[i - begin] + K * dim] += points.weights[i] * Storage::decode(column[i - begin], scale, offset);
+            }
+        }
+    }
+
+
+    bool KMeans::KMeansIteration(IterationMetrics& metrics) {
+        // Number of threads of the team.
+        const int numThreads = omp_get_max_threads();
+
+        // Blocks of points of the assignment (units of the work-stealing pool).
+        const bool deterministic = options.reduction == DETERMINISTIC;
+        int blockSize = kernel.pointTile; // Number of points of a block.
+        if (deterministic) {
+            // Fixed-size blocks depending only on the workload (with a bounded number of partial sums).
+            const long long maxBlocks = std::max(1LL, std::min((long long) MAX_REDUCTION_BLOCKS, (long long) MAX_REDUCTION_MEMORY / (8LL * K * (dimensions + 1))));
+            blockSize = std::max(REDUCTION_BLOCK_SIZE, (int) ((N + maxBlocks - 1) / maxBlocks));
+        }
+        const int numBlocks = (int) ((N + blockSize - 1) / blockSize); // Number of blocks.
+
+        // Variables for the mean of the points in each cluster (a partial for each block with the deterministic reduction, for each thread otherwise).
+        const int numPartials = deterministic ? numBlocks : numThreads;
+        if (clustersSum.size() != (size_t) numPartials * K * dimensions) {
+            clustersSum.assign((size_t) numPartials * K * dimensions, 0); // Sum of coordinates of points in each cluster.
+            clustersSize.assign((size_t) numPartials * K, 0); // Weighted number of points in each cluster.
+            partialsInertia.assign(numPartials, 0); // Sum of the squared distances of the points to their centroid.
+        }
+
+        // Previous coordinates of the centroids.
+        std::vector<double> previousCoordinates(K * dimensions, 0);
+
+        // Convergence flag. Assume convergence at the beginning.
+        bool converged = true;
+
+        // Variables for the metrics of the iteration.
+        long long moved = 0; // Number of points that changed cluster.
+        double maxShift = 0; // Maximum squared displacement of a centroid.
+
+        // Variables for the recall audit of the approximate assignment.
+        const bool auditing = (kernel.engine == IVF && options.recallAudit) || kernel.engine == PROJECTED;
+        const long long auditStride = std::max(1LL, N / AUDIT_SAMPLE); // Stride between the audited points.
+        const int auditSamples = (int) ((N + auditStride - 1) / auditStride); // Number of audited points.
+        long long hits = 0; // Audited points assigned to their exact closest centroid.
+        double approximateInertia = 0, exactInertia = 0; // Weighted inertia of the audited points with the approximate and exact assignments.
+
+        #pragma omp parallel default(none) shared(numThreads, deterministic, blockSize, numBlocks, numPartials, previousCoordinates, converged, moved, maxShift, auditing, auditStride, auditSamples, hits, approximateInertia, exactInertia)
+        {
+            const int thread = omp_get_thread_num();
+
+            {
+                ScopedPhase phase(profiler, tracer, ASSIGNMENT);
+
+                // Buffers of the thread for the closest centroids of a tile of points.
+                std::vector<int> minClustersIds(kernel.pointTile);
+                std::vector<double> minDistances(kernel.pointTile);
+                std::vector<double> distances(kernel.engine == TILED || quantized.precision != DOUBLE ? kernel.pointTile * kernel.centroidTile : 0);
+
+                if (!deterministic) {
+                    // Reset the partial sums of the thread.
+                    std::fill(&clustersSum[(size_t) thread * K * dimensions], &clustersSum[(size_t) (thread + 1) * K * dimensions], 0);
+                    std::fill(&clustersSize[(size_t) thread * K], &clustersSize[(size_t) (thread + 1) * K], 0);
+                    partialsInertia[thread] = 0;
+                }
+
+                if (kernel.engine == IVF) {
+                    // Build the index over the current centroids.
+                    index.build(centroids);
+                } else if (kernel.engine == PROJECTED) {
+                    // Project the current centroids (and the points the first time).
+                    projection.build(points, centroids);
+                }
+
+                // Partition the blocks among the threads.
+                #pragma omp single
+                pool.reset(numBlocks, omp_get_num_threads());
+
+                // Points moved by the thread.
+                long long threadMoved = 0;
+
+                // Assign the chunks of blocks of points to the closest centroids.
+                int first, last, owner;
+                while (pool.next(thread, first, last, owner)) {
+                    const double chunkStartTime = omp_get_wtime();
+
+                    for(int block = first; block < last; block++) {
+                        // Partial sums of the block (or of the thread).
+                        const int partial = deterministic ? block : thread;
+                        double* sums = &clustersSum[(size_t) partial * K * dimensions];
+                        double* sizes = &clustersSize[(size_t) partial * K];
+
+                        if (deterministic) {
+                            // Reset the partial sums of the block.
+                            std::fill(sums, sums + K * dimensions, 0);
+                            std::fill(sizes, sizes + K, 0);
+                            partialsInertia[partial] = 0;
+                        }
+
+                        const long long begin = (long long) block * blockSize; // Identifier of the first point of the block.
+                        const long long end = std::min(N, begin + blockSize); // Identifier after the last point of the block.
+                        assignBlock(begin, end, sums, sizes, minClustersIds.data(), minDistances.data(), distances.data(), threadMoved, partialsInertia[partial]);
+                    }
+
+                    // Account the time of the chunk for the imbalance.
+                    pool.account(thread, owner, omp_get_wtime() - chunkStartTime);
+                }
+
+                #pragma omp atomic
+                moved += threadMoved;
+            }
+
+            // Wait for the partial sums of all the threads.
+            #pragma omp barrier
+
+            if (auditing) {
+                // Compare the approximate assignment of a sample of points with the exact one (before the update of the centroids).
+                #pragma omp for schedule(static) reduction(+:hits, approximateInertia, exactInertia)
+                for(int s = 0; s < auditSamples; s++) {
+                    const long long i = s * auditStride;
+
+                    double minDist = DBL_MAX;
+                    int minClusterId = -1;
+                    for(int j = 0; j < K; j++) {
+                        const double dist = distance<SquaredEuclidean>(i, j);
+                        if (dist < minDist) {
+                            minDist = dist;
+                            minClusterId = j;
+                        }
+                    }
+
+                    const double assignedDist = distance<SquaredEuclidean>(i, points.clustersIds[i]);
+                    hits += points.clustersIds[i] == minClusterId || assignedDist == minDist;
+                    approximateInertia += points.weights[i] * assignedDist;
+                    exactInertia += points.weights[i] * minDist;
+                }
+            }
+
+            {
+                ScopedPhase phase(profiler, tracer, REDUCTION);
+
+                if (deterministic) {
+                    // Reduce the partial sums of the blocks into the first one with a fixed pairwise tree (independent of the number of threads).
+                    #pragma omp for schedule(static) nowait
+                    for(int e = 0; e < K * dimensions; e++) {
+                        for(int stride = 1; stride < numPartials; stride *= 2) {
+                            for(int p = 0; p + stride < numPartials; p += 2 * stride) {
+                                clustersSum[(size_t) p * K * dimensions + e] += clustersSum[(size_t) (p + stride) * K * dimensions + e];
+                            }
+                        }
+                    }
+                } else {
+                    // Reduce the partial sums of the threads into the first one.
+                    #pragma omp for schedule(static) nowait
+                    for(int e = 0; e < K * dimensions; e++) {
+                        for(int t = 1; t < numPartials; t++) {
+                            clustersSum[e] += clustersSum[(size_t) t * K * dimensions + e];
+                        }
+                    }
+                }
+
+                // Reduce the partial sizes into the first one.
+                #pragma omp for schedule(static) nowait
+                for(int j = 0; j < K; j++) {
+                    for(int t = 1; t < numPartials; t++) {
+                        clustersSize[j] += clustersSize[(size_t) t * K + j];
+                    }
+                }
+            }
+
+            // Wait for the reduced sums and sizes (outside of the phase, so that the phase measures the work of the thread and not its wait).
+            #pragma omp barrier
+
+            {
+                ScopedPhase phase(profiler, tracer, UPDATE);
+
+                // Update the centroids.
+                #pragma omp for schedule(static) nowait
+                for(int j = 0; j < K; j++) {
+                    for(int dim = 0; dim < dimensions; dim++) {
+                        // Save the previous centroid coordinates.
+                        previousCoordinates[j + K * dim] = centroids.coordinates[j + K * dim];
+
+                        // Calculate the new centroid coordinates (the mean, except with the Manhattan metric; an empty cluster keeps its centroid).
+                        if (options.metric != MANHATTAN && clustersSize[j] > 0) {
+                            centroids.coordinates[j + K * dim] = clustersSum[j + K * dim] / clustersSize[j];
+                        }
+                    }
+
+                    if (options.metric == COSINE) {
+                        // Renormalize the centroid to a unit vector (spherical k-means).
+                        double norm = 0;
+                        for(int dim = 0; dim < dimensions; dim++) {
+                            norm += centroids.coordinates[j + K * dim] * centroids.coordinates[j + K * dim];
+                        }
+                        norm = sqrt(norm);
+
+                        for(int dim = 0; dim < dimensions && norm > 0; dim++) {
+                            centroids.coordinates[j + K * dim] /= norm;
+                        }
+                    }
+                }
+
+                if (options.metric == MANHATTAN) {
+                    // Calculate the new centroid coordinates as the weighted medians.
+                    updateMedians();
+                }
+            }
+
+            // Wait for the updated centroids.
+            #pragma omp barrier
+
+            {
+                ScopedPhase phase(profiler, tracer, CONVERGENCE);
+
+                // Check for convergence (i.e. if a centroid change position in a dimension) and compute the shift of the centroids (the end of the parallel region waits for the threads).
+                #pragma omp for schedule(static) reduction(&&:converged) reduction(max:maxShift) nowait
+                for(int j = 0; j < K; j++) {
+                    double shift = 0;
+
+                    for(int dim = 0; dim < dimensions; dim++) {
+                        const double difference = previousCoordinates[j + K * dim] - centroids.coordinates[j + K * dim];
+
+                        if (fabs(difference) > EPSILON) {
+                            converged = false;
+                        }
+
+                        shift += difference * difference;
+                    }
+
+                    maxShift = std::max(maxShift, shift);
+                }
+            }
+        }
+
+        // Sum the inertia of the partials in a fixed order.
+        double inertia = 0;
+        for(int p = 0; p < numPartials; p++) {
+            inertia += partialsInertia[p];
+        }
+
+        // Set the metrics of the iteration.
+        metrics.moved = moved;
+        metrics.inertia = inertia;
+        metrics.maxShift = sqrt(maxShift);
+
+        if (auditing) {
+            // Accumulate the audit of the iteration.
+            metrics.recall = (double) hits / auditSamples;
+            audit.samples += auditSamples;
+            audit.hits += hits;
+            audit.approximateInertia += approximateInertia;
+            audit.exactInertia += exactInertia;
+        }
 
         return converged;
     }
@@ -284,7 +1372,7 @@ namespace Parallel {
         std::vector<std::vector<double>> coordinates(data.size, std::vector<double>(data.dimensions, 0));
         
         // Fill the coordinates vector.
-        for(int i = 0; i < data.size; i++) {
+        for(long long i = 0; i < data.size; i++) {
             for(int dim = 0; dim < data.dimensions; dim++) {
                 coordinates[i][dim] = data.coordinates[i + data.size * dim];
             }
@@ -299,10 +1387,80 @@ namespace Parallel {
         std::vector<int> ids(data.size, 0);
         
         // Fill the clusters ids vector.
-        for(int i = 0; i < data.size; i++) {
+        for(long long i = 0; i < data.size; i++) {
             ids[i] = data.clustersIds[i];
         }
 
         return ids;
     }
+
+    void KMeans::writeOutput() {
+        const double startTime = omp_get_wtime();
+
+        const std::string extension = options.outputFormat == CSV_OUTPUT ? ".csv" : ".bin";
+        writeLabels(options.output + ".labels" + extension, points.clustersIds, rowToPoint.empty() ? nullptr : rowToPoint.data(), rows, options.outputFormat, omp_get_max_threads());
+        writeCentroids(options.output + ".centroids" + extension, centroids, options.outputFormat, omp_get_max_threads());
+
+        const double endTime = omp_get_wtime();
+        tracer.stage("output", startTime, endTime);
+
+        std::cout << "Wrote the labels of " << rows << " points and " << K << " centroids (" << OUTPUT_FORMAT_NAMES[options.outputFormat] << ") to " << options.output << ".* in " << endTime - startTime << " seconds." << std::endl;
+    }
+
+    void KMeans::reportEvaluation() {
+        const double startTime = omp_get_wtime();
+        const Evaluation evaluation = evaluate(points, centroids, options.metric, omp_get_max_threads());
+        const double endTime = omp_get_wtime();
+        tracer.stage("evaluation", startTime, endTime);
+
+        std::cout << "Quality: Davies-Bouldin " << evaluation.daviesBouldin;
+        if (options.metric == EUCLIDEAN) {
+            std::cout << ", Calinski-Harabasz " << evaluation.calinskiHarabasz;
+        }
+        std::cout << ", silhouette " << evaluation.silhouette;
+        if (evaluation.exact) {
+            std::cout << " (exact on " << evaluation.silhouettePoints << " points)";
+        } else {
+            std::cout << " [" << evaluation.silhouetteLow << ", " << evaluation.silhouetteHigh << "] (95% confidence, stratified sample of " << evaluation.silhouettePoints << " points)";
+        }
+        std::cout << " in " << endTime - startTime << " seconds." << std::endl;
+    }
+
+    void KMeans::saveCheckpoint(const int iterations, const bool converged, const double executionTimes, const double inertia) {
+        const double startTime = omp_get_wtime();
+
+        if (pointsFingerprint == 0) {
+            pointsFingerprint = fingerprint(points, omp_get_max_threads());
+        }
+
+        Checkpoint state;
+        state.rows = rows;
+        state.fingerprint = pointsFingerprint;
+        state.metric = options.metric;
+        state.iterations = iterations;
+        state.converged = converged;
+        state.executionTimes = executionTimes;
+        state.inertia = inertia;
+        state.auditSamples = audit.samples;
+        state.auditHits = audit.hits;
+        state.auditApproximateInertia = audit.approximateInertia;
+        state.auditExactInertia = audit.exactInertia;
+
+        writeCheckpoint(options.checkpoint, state, centroids);
+
+        tracer.stage("checkpoint", startTime, omp_get_wtime());
+    }
+
+    const std::vector<int> KMeans::getLabels() {
+        // Initialize the labels vector.
+        std::vector<int> labels(rows, 0);
+
+        // Fill the labels vector (mapping the original points to the points).
+        #pragma omp parallel for schedule(static)
+        for(long long i = 0; i < rows; i++) {
+            labels[i] = points.clustersIds[rowToPoint.empty() ? i : rowToPoint[i]];
+        }
+
+        return labels;
+    }
 }
\ No newline at end of file
@@ -2,9 +2,22 @@
 #define K_MEANS_PARALLEL_H
 
 #include <vector>
+#include <memory>
+#include <omp.h>
 
 #include "points.h"
 #include "centroids.h"
+#include "options.h"
+#include "profiler.h"
+#include "tracer.h"
+#include "scheduler.h"
+#include "ivf.h"
+#include "projection.h"
+#include "quantized.h"
+#include "model.h"
+#include "checkpoint.h"
+#include "reservoir.h"
+#include "../utils.h"
 
 
 namespace Parallel {
@@ -17,8 +30,9 @@ namespace Parallel {
                 * @param K: Number of clusters.
                 * @param dimensions: Number of dimensions.
                 * @param threads: Number of threads.
+                * @param options: Optional settings of the execution.
             */
-            KMeans(const int N, const int K, const int dimensions, const int threads);
+            KMeans(const long long N, const int K, const int dimensions, const int threads, const Options& options = Options());
 
             /*
                 * KMeans constructor with points from dataset file.
@@ -26,8 +40,29 @@ namespace Parallel {
                 * @param filePath: Path of the file with the points.
                 * @param K: Number of clusters.
                 * @param threads: Number of threads.
+                * @param options: Optional settings of the execution.
             */
-            KMeans(const std::string& filePath, const int K, const int threads);
+            KMeans(const std::string& filePath, const int K, const int threads, const Options& options = Options());
+
+            /*
+                * KMeans constructor with given points and initial centroids.
+                * 
+                * @param points: The points (moved into the instance).
+                * @param centroids: The initial centroids (moved into the instance).
+                * @param threads: Number of threads.
+                * @param options: Optional settings of the execution.
+            */
+            KMeans(Points&& points, Centroids&& centroids, const int threads, const Options& options = Options());
+
+            /*
+                * KMeans constructor with given points (seeded as the points of a dataset file).
+                * 
+                * @param points: The points (moved into the instance and preprocessed with the options).
+                * @param K: Number of clusters.
+                * @param threads: Number of threads.
+                * @param options: Optional settings of the execution.
+            */
+            KMeans(Points&& points, const int K, const int threads, const Options& options = Options());
 
 
             /*
@@ -38,6 +73,13 @@ namespace Parallel {
             */
             void run(const std::string &base_path = "results\\", const bool log = false);
 
+            /*
+                * Execution of the k-means algorithm without any output to the filesystem.
+                *
+                * @returns (Model) The fitted model (centroids, inertia and iterations).
+            */
+            Model fit();
+
 
             /*
                 * Get the coordinates of the data.
@@ -59,15 +101,200 @@ namespace Parallel {
             template <typename T>
             const std::vector<int> getClustersIds(const T& data);
 
+            /*
+                * Get the identifiers of the clusters of the original points (mapping back the deduplicated points).
+                * 
+                * @returns (std::vector<int>) The identifiers of the clusters of the original points.
+            */
+            const std::vector<int> getLabels();
+
         private:
+            friend class Autotuner;
+
+            const double constructionTime = omp_get_wtime(); // Wall time at the beginning of the construction (for the time to the first iteration).
+            double firstIterationTime = -1; // Time from the beginning of the construction to the first iteration (-1 until the iterations start).
+
             const std::string filePath = ""; // Path of the file with the points.
-            int N; // Number of points.
+            long long N; // Number of points.
             const int K; // Number of clusters.
             int dimensions; // Number of dimensions.
             const int threads; // Number of threads.
+            const Options options; // Optional settings of the execution.
+            KernelConfig kernel; // Configuration of the assignment kernel (possibly tuned).
+
+            Tracer tracer; // Tracer of the execution (created first to trace the loading and the seeding).
+            Reservoir reservoir; // Uniform sample of K rows of the input file, fed while it is loaded (only with the pipelined seeding).
+
+            long long rows = 0; // Number of original points (before the pre-passes).
+            std::vector<long long> rowToPoint; // Map from the original points to the points (empty if identity).
+
+            Checkpoint resumed; // State of the iterations resumed from a checkpoint (declared before the centroids, which restore it).
+            uint64_t pointsFingerprint = 0; // Fingerprint of the points of the checkpoints (0 until computed).
 
             Points points; // Vector of points.
             Centroids centroids; // Vector of centroids.
+            std::unique_ptr<Centroids> sweptCentroids; // Centroids of the largest K of the K sweep (null without a sweep).
+
+            Profiler profiler; // Profiler of the iteration phases.
+            WorkStealingPool pool; // Pool of the blocks of points of the assignment phase.
+            CentroidIndex index; // Index over the centroids (only with the IVF engine).
+            Projection projection; // Random-projection sketch of the points and the centroids (only with the projected engine).
+            QuantizedPoints quantized; // Coordinates of the points with reduced precision (only with a reduced precision).
+
+            // Audit of the approximate assignment against the exact one (accumulated over the iterations).
+            struct {
+                long long samples = 0; // Number of audited points.
+                long long hits = 0; // Audited points assigned to their exact closest centroid.
+                double approximateInertia = 0; // Weighted inertia of the audited points with the approximate assignment.
+                double exactInertia = 0; // Weighted inertia of the audited points with the exact assignment.
+            } audit;
+
+            std::vector<double> clustersSum; // Partial sums of coordinates of points in each cluster (for each block or thread).
+            std::vector<double> clustersSize; // Partial weighted number of points in each cluster (for each block or thread).
+            std::vector<double> partialsInertia; // Partial weighted sums of the squared distances of the points to their centroid.
+
+            std::vector<long long> clustersOffsets; // Offset of each cluster in the points grouped by cluster (only with the Manhattan metric).
+            std::vector<long long> clustersPoints; // Points grouped by cluster (only with the Manhattan metric).
+
+
+            /*
+                * Checks the options and configures the threads and the assignment kernel (autotuned if required).
+            */
+            void configure();
+
+            /*
+                * Executes the k-means algorithm (bisecting or on the coreset if required), quantizing the points first with a reduced precision.
+                *
+                * @param paths: Paths of the folders for logging.
+                * @param canPlot: True if the iterations should be logged and plotted.
+                * @param executionTimes: Execution time of the algorithm (accumulated).
+                * @param inertia: Weighted inertia of the points.
+                *
+                * @returns (int) The number of iterations.
+            */
+            int execute(const FolderPaths& paths, const bool canPlot, double& executionTimes, double& inertia);
+
+            /*
+                * Executes the iterations of the k-means algorithm until convergence.
+                *
+                * @param paths: Paths of the folders for logging.
+                * @param canPlot: True if the iterations should be logged and plotted.
+                * @param executionTimes: Execution time of the iterations (accumulated).
+                * @param inertia: Weighted inertia of the last iteration.
+                *
+                * @returns (int) The number of iterations.
+            */
+            int solve(const FolderPaths& paths, const bool canPlot, double& executionTimes, double& inertia);
+
+            /*
+                * Executes the k-means algorithm on a coreset of the points, optionally followed by an assignment pass over all the points
+                * and compared with the full Lloyd on the same points.
+                *
+                * @param executionTimes: Execution time of the coreset construction, clustering and assignment pass.
+                * @param inertia: Weighted inertia of the points (or of the coreset without the assignment pass).
+                *
+                * @returns (int) The number of iterations on the coreset.
+            */
+            int solveCoreset(double& executionTimes, double& inertia);
+
+            /*
+                * Executes the bisecting k-means, optionally followed by the flat iterations to refine the clusters.
+                *
+                * @param executionTimes: Execution time of the bisecting and of the refinement.
+                * @param inertia: Weighted inertia of the points.
+                *
+                * @returns (int) The number of iterations of the refinement.
+            */
+            int solveBisecting(double& executionTimes, double& inertia);
+
+            /*
+                * Executes the flat iterations on uniform subsamples of growing size (from the fraction of the options, by MULTIRES_FACTOR),
+                * each stage warm-started from the previous one, and finally on all the points.
+                *
+                * @param paths: Paths of the folders of the logs of the final stage.
+                * @param canPlot: True if the iterations of the final stage should be logged and plotted.
+                * @param executionTimes: Execution time of all the stages.
+                * @param inertia: Weighted inertia of the points.
+                *
+                * @returns (int) The number of iterations on all the points.
+            */
+            int solveMultiresolution(const FolderPaths& paths, const bool canPlot, double& executionTimes, double& inertia);
+
+            /*
+                * Executes the flat iterations for a range of numbers of clusters as a warm-started chain on the same points
+                * (each K starts from the solution of the previous one plus D²-sampled centroids) and reports the inertia and the Calinski-Harabasz score of each K.
+                *
+                * @param executionTimes: Execution time of the whole chain.
+                * @param inertia: Weighted inertia of the points with the largest K.
+                *
+                * @returns (int) The total number of iterations of the chain.
+            */
+            int solveSweep(double& executionTimes, double& inertia);
+
+            /*
+                * Adds centroids drawn among the points with a probability proportional to their weighted distance to the closest centroid (D² sampling),
+                * using the current assignment of the points.
+                *
+                * @param added: Number of added centroids.
+                *
+                * @returns (Centroids) The current centroids followed by the added ones.
+            */
+            template <typename Metric>
+            Centroids growCentroids(const int added);
+
+            /*
+                * Assigns each point to the closest centroid without updating the centroids.
+                *
+                * @returns (double) The weighted inertia of the points.
+            */
+            double assign();
+
+            /*
+                * Normalizes the points to unit vectors (zero vectors are left unchanged).
+                *
+                * @param data: The points.
+            */
+            void normalize(Points& data);
+
+            /*
+                * Updates the centroids to the weighted median of their points in each dimension (must be called by all the threads of a parallel region, which wait for the centroids with a barrier afterwards).
+            */
+            void updateMedians();
+
+            /*
+                * Prints the inertia deviation of the reduced precision execution against the double precision engine from the same initial centroids.
+                *
+                * @param initialCentroids: The initial centroids (moved into the reference execution).
+                * @param executionTimes: Execution time of the reduced precision iterations.
+            */
+            void reportPrecision(Centroids&& initialCentroids, const double executionTimes);
+
+            /*
+                * Prints the quality metrics of the clustering (Davies-Bouldin, Calinski-Harabasz and silhouette).
+            */
+            void reportEvaluation();
+
+            /*
+                * Writes the final labels of the original points and the centroids to the output files.
+            */
+            void writeOutput();
+
+            /*
+                * Writes a checkpoint of the centroids and the state of the iterations.
+                *
+                * @param iterations: Number of completed iterations.
+                * @param converged: True if the last iteration converged.
+                * @param executionTimes: Execution time of the completed iterations.
+                * @param inertia: Inertia of the last iteration.
+            */
+            void saveCheckpoint(const int iterations, const bool converged, const double executionTimes, const double inertia);
+
+            /*
+                * Gets the options of the nested executions (e.g. on a coreset), with the same kernel and without instrumentation and pre-passes.
+                *
+                * @returns (Options) The options of the nested executions.
+            */
+            Options nestedOptions() const;
 
 
             /*
@@ -75,14 +302,32 @@ namespace Parallel {
                 *
                 * @returns (Points) The points.
             */
-            const Points initializeRandomPoints();
+            Points initializeRandomPoints();
 
             /*
                 * Initializes the points with form input file.
                 *
                 * @returns (std::vector<Point>) Vector of points.
             */
-            const Points initializeInputPoints();
+            Points initializeInputPoints();
+
+            /*
+                * Applies the optional pre-passes (normalization, deduplication and reordering) to the loaded points.
+                *
+                * @param points: The loaded points.
+                *
+                * @returns (Points) The points to cluster.
+            */
+            Points preprocessPoints(Points&& points);
+
+            /*
+                * Sorts the points by the space-filling curve of the options, keeping the labels of the original points.
+                *
+                * @param points: The points.
+                *
+                * @returns (Points) The reordered points (the same points with the input order).
+            */
+            Points reorderPoints(Points&& points);
 
             /*
                 * Initializes the centroids with k random points.
@@ -93,22 +338,117 @@ namespace Parallel {
 
 
             /*
-                * Calculates the Euclidean distance between a point and a centroid.
+                * Calculates the distance between a point and a centroid with a metric policy.
                 * 
                 * @param pointId: The identifier of the point.
                 * @param centroidId: The identifier of the centroid.
                 * 
-                * @returns (double) The distance between the point and the centroid.
+                * @returns (double) The distance between the point and the centroid (squared for the Euclidean metric).
+            */
+            template <typename Metric>
+            double distance(const long long pointId, const int centroidId);
+
+            /*
+                * Assigns a tile of points to the closest centroid computing each distance separately.
+                * 
+                * @param begin: The identifier of the first point of the tile.
+                * @param end: The identifier after the last point of the tile.
+                * @param minClustersIds: Array of identifiers of the closest centroids of the tile points.
+                * @param minDistances: Array of distances to the closest centroids of the tile points.
+            */
+            template <typename Metric>
+            void assignNaive(const long long begin, const long long end, int* minClustersIds, double* minDistances);
+
+            /*
+                * Assigns a tile of points to the closest centroid from the quantized coordinates (decoded to float, as the tiled kernel).
+                *
+                * @param begin: Identifier of the first point of the tile.
+                * @param end: Identifier after the last point of the tile.
+                * @param minClustersIds: Array of identifiers of the closest centroids of the tile points.
+                * @param minDistances: Array of squared distances to the closest centroids of the tile points.
+                * @param distances: Buffer of pointTile x centroidTile squared distances.
+            */
+            template <typename Storage>
+            void assignQuantized(const long long begin, const long long end, int* minClustersIds, double* minDistances, double* distances);
+
+            /*
+                * Sums the weighted decoded coordinates of a tile of quantized points into the partial sums of their clusters.
+                *
+                * @param begin: Identifier of the first point of the tile.
+                * @param end: Identifier after the last point of the tile.
+                * @param minClustersIds: Array of identifiers of the closest centroids of the tile points.
+                * @param sums: Partial sums of the coordinates of the clusters.
+            */
+            template <typename Storage>
+            void accumulateQuantized(const long long begin, const long long end, const int* minClustersIds, double* sums);
+
+            /*
+                * Assigns a tile of points to the approximate closest centroid found in the centroid index.
+                *
+                * @param begin: Identifier of the first point of the tile.
+                * @param end: Identifier after the last point of the tile.
+                * @param minClustersIds: Array of identifiers of the closest centroids of the tile points.
+                * @param minDistances: Array of squared distances to the closest centroids of the tile points.
+            */
+            void assignIndexed(const long long begin, const long long end, int* minClustersIds, double* minDistances);
+
+            /*
+                * Assigns a tile of points to the closest centroid among the shortlist of the random-projection sketch.
+                *
+                * @param begin: Identifier of the first point of the tile.
+                * @param end: Identifier after the last point of the tile.
+                * @param minClustersIds: Array of identifiers of the closest centroids of the tile points.
+                * @param minDistances: Array of squared distances to the closest centroids of the tile points.
+            */
+            void assignProjected(const long long begin, const long long end, int* minClustersIds, double* minDistances);
+
+            /*
+                * Assigns a tile of points to the closest centroid with the configured engine.
+                *
+                * @param begin: Identifier of the first point of the tile.
+                * @param end: Identifier after the last point of the tile.
+                * @param minClustersIds: Array of identifiers of the closest centroids of the tile points.
+                * @param minDistances: Array of squared distances to the closest centroids of the tile points.
+                * @param distances: Buffer of pointTile x centroidTile squared distances (only with the tiled engine).
+            */
+            void assignTile(const long long begin, const long long end, int* minClustersIds, double* minDistances, double* distances);
+
+            /*
+                * Assigns a tile of points to the closest centroid computing the distances to a tile of centroids at once (vectorized over the points).
+                * 
+                * @param begin: The identifier of the first point of the tile.
+                * @param end: The identifier after the last point of the tile.
+                * @param minClustersIds: Array of identifiers of the closest centroids of the tile points.
+                * @param minDistances: Array of distances to the closest centroids of the tile points.
+                * @param distances: Buffer of pointTile x centroidTile distances.
+            */
+            template <typename Metric>
+            void assignTiled(const long long begin, const long long end, int* minClustersIds, double* minDistances, double* distances);
+
+            /*
+                * Assigns a block of points to the closest centroid and accumulates them (in point order) into partial sums.
+                * 
+                * @param begin: The identifier of the first point of the block.
+                * @param end: The identifier after the last point of the block.
+                * @param sums: Partial sums of coordinates of points in each cluster.
+                * @param sizes: Partial weighted number of points in each cluster.
+                * @param minClustersIds: Buffer of pointTile identifiers of the closest centroids.
+                * @param minDistances: Buffer of pointTile squared distances to the closest centroids.
+                * @param distances: Buffer of pointTile x centroidTile squared distances (only with the tiled engine).
+                * @param moved: Number of points that changed cluster.
+                * @param inertia: Partial weighted sum of the squared distances of the points to their centroid.
             */
-            const double distance(const int pointId, const int centroidId);
+            void assignBlock(const long long begin, const long long end, double* sums, double* sizes, int* minClustersIds, double* minDistances, double* distances, long long& moved, double& inertia);
 
 
             /*
                 * Performs a single iteration of the k-means algorithm.
                 * 
+                * @param metrics: The metrics of the iteration (points moved, inertia and maximum centroid shift).
+                * 
                 * @returns (bool) True if the centroids have changed, false otherwise.
             */
-            bool KMeansIteration();
+            bool KMeansIteration(IterationMetrics& metrics);
     };
 }
 
@@ -0,0 +1,435 @@
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <omp.h>
+
+#include <zlib.h>
+#ifdef K_MEANS_ZSTD
+#include <zstd.h>
+#endif
+
+#include "loader.h"
+#include "../params.h"
+
+
+namespace Parallel {
+    // Source of the (decompressed) bytes of a dataset file.
+    class DatasetSource {
+        public:
+            /*
+                * Reads the next bytes of the file.
+                *
+                * @param buffer: Buffer of the bytes.
+                * @param size: Maximum number of bytes read.
+                *
+                * @returns (size_t) Number of bytes read (less than the size only at the end of the file).
+            */
+            virtual size_t read(char* buffer, const size_t size) = 0;
+
+            virtual ~DatasetSource() {}
+    };
+
+    // Uncompressed file.
+    class PlainSource : public DatasetSource {
+        public:
+            PlainSource(const std::string& filePath) : file(fopen(filePath.c_str(), "rb")) {
+                if (file == nullptr) {
+                    throw std::runtime_error("ERROR: couldn't open file");
+                }
+            }
+
+            size_t read(char* buffer, const size_t size) override {
+                const size_t bytes = fread(buffer, 1, size, file);
+                if (bytes < size && ferror(file)) {
+                    throw std::runtime_error("ERROR: couldn't read file");
+                }
+
+                return bytes;
+            }
+
+            ~PlainSource() {
+                fclose(file);
+            }
+
+        private:
+            FILE* file;
+    };
+
+    // Gzip-compressed file (of one or more members).
+    class GzipSource : public DatasetSource {
+        public:
+            GzipSource(const std::string& filePath) : file(gzopen(filePath.c_str(), "rb")) {
+                if (file == nullptr) {
+                    throw std::runtime_error("ERROR: couldn't open file");
+                }
+                gzbuffer(file, LOAD_CHUNK);
+            }
+
+            size_t read(char* buffer, const size_t size) override {
+                size_t bytes = 0;
+                while (bytes < size) {
+                    const int read = gzread(file, buffer + bytes, (unsigned) std::min<size_t>(size - bytes, 1u << 30));
+
+                    // A truncated stream ends with a buffer error.
+                    int code = Z_OK;
+                    const char* message = gzerror(file, &code);
+                    if (read < 0 || (code != Z_OK && code != Z_STREAM_END)) {
+                        throw std::runtime_error(std::string("ERROR: couldn't decompress file (") + message + ")");
+                    }
+                    if (read == 0) {
+                        break;
+                    }
+                    bytes += read;
+                }
+
+                return bytes;
+            }
+
+            ~GzipSource() {
+                gzclose(file);
+            }
+
+        private:
+            gzFile file;
+    };
+
+#ifdef K_MEANS_ZSTD
+    // Zstandard-compressed file (of one or more frames).
+    class ZstdSource : public DatasetSource {
+        public:
+            ZstdSource(const std::string& filePath) : file(fopen(filePath.c_str(), "rb")), context(ZSTD_createDCtx()), compressed(ZSTD_DStreamInSize()) {
+                if (file == nullptr) {
+                    ZSTD_freeDCtx(context);
+                    throw std::runtime_error("ERROR: couldn't open file");
+                }
+                input = {compressed.data(), 0, 0};
+            }
+
+            size_t read(char* buffer, const size_t size) override {
+                ZSTD_outBuffer output = {buffer, size, 0};
+                while (output.pos < output.size) {
+                    // Refill the compressed bytes (the decoder flushes all it can before it asks for more input).
+                    if (input.pos == input.size) {
+                        input.size = fread(compressed.data(), 1, compressed.size(), file);
+                        input.pos = 0;
+                        if (input.size == 0) {
+                            if (!finished) {
+                                throw std::runtime_error("ERROR: couldn't decompress file (truncated frame)");
+                            }
+                            break;
+                        }
+                    }
+
+                    const size_t result = ZSTD_decompressStream(context, &output, &input);
+                    if (ZSTD_isError(result)) {
+                        throw std::runtime_error(std::string("ERROR: couldn't decompress file (") + ZSTD_getErrorName(result) + ")");
+                    }
+                    finished = result == 0;
+                }
+
+                return output.pos;
+            }
+
+            ~ZstdSource() {
+                ZSTD_freeDCtx(context);
+                fclose(file);
+            }
+
+        private:
+            FILE* file;
+            ZSTD_DCtx* context;
+            std::vector<char> compressed; // Buffer of the compressed bytes.
+            ZSTD_inBuffer input; // Unconsumed part of the compressed bytes.
+            bool finished = true; // True if the decoder is at the end of a frame.
+    };
+#endif
+
+    /*
+        * Checks the extension of a file path.
+        *
+        * @param filePath: Path of the file.
+        * @param extension: The extension (with its dot).
+        *
+        * @returns (bool) True if the path ends with the extension.
+    */
+    static bool hasExtension(const std::string& filePath, const std::string& extension) {
+        return filePath.size() >= extension.size() && filePath.compare(filePath.size() - extension.size(), extension.size(), extension) == 0;
+    }
+
+    /*
+        * Opens the source of the bytes of a dataset file (decompressed on the fly if its extension is '.gz' or '.zst').
+        *
+        * @param filePath: Path of the file.
+        *
+        * @returns (std::unique_ptr<DatasetSource>) The source of the bytes.
+    */
+    static std::unique_ptr<DatasetSource> openSource(const std::string& filePath) {
+        if (hasExtension(filePath, ".gz")) {
+            return std::make_unique<GzipSource>(filePath);
+        }
+        if (hasExtension(filePath, ".zst")) {
+            #ifdef K_MEANS_ZSTD
+            return std::make_unique<ZstdSource>(filePath);
+            #else
+            throw std::runtime_error("ERROR: zstd support not compiled in (build with -DK_MEANS_ZSTD -lzstd)");
+            #endif
+        }
+
+        return std::make_unique<PlainSource>(filePath);
+    }
+
+    // Chunk of whole lines of a dataset file, parsed into rows.
+    struct LoadChunk {
+        long long index = 0; // Index of the chunk in the file.
+        std::string text; // Text of the lines (released once parsed).
+        std::vector<double> values; // Values of the rows (row-major).
+        long long rows = 0; // Number of rows.
+        int columns = 0; // Number of columns of the rows.
+        bool failed = false; // True if the chunk has an invalid line.
+    };
+
+    bool parseRows(std::string& text, std::vector<double>& values, long long& rows, int& columns, long long* skipped) {
+        char* cursor = text.data();
+        char* const end = cursor + text.size();
+        values.reserve(values.size() + text.size() / 8);
+
+        while (cursor < end) {
+            char* lineEnd = (char*) memchr(cursor, '\n', end - cursor);
+            if (lineEnd == nullptr) lineEnd = end;
+            *lineEnd = '\0'; // The text has a terminator after its last byte.
+
+            // Skip the blank lines.
+            char* c = cursor;
+            while (c < lineEnd && (*c == ' ' || *c == '\t' || *c == '\r')) c++;
+
+            if (c < lineEnd) {
+                const size_t rowStart = values.size();
+                int lineColumns = 0;
+                bool valid = true;
+                while (true) {
+                    char* next;
+                    const double value = strtod(c, &next);
+                    if (next == c) {
+                        valid = false;
+                        break;
+                    }
+                    values.push_back(value);
+                    lineColumns++;
+
+                    while (*next == ' ' || *next == '\t' || *next == '\r') next++;
+                    if (*next != ',') {
+                        valid = *next == '\0';
+                        break;
+                    }
+                    c = next + 1;
+                }
+
+                if ((rows > 0 || (skipped != nullptr && columns > 0)) && lineColumns != columns) {
+                    valid = false;
+                }
+
+                if (!valid) {
+                    if (skipped == nullptr) {
+                        return false;
+                    }
+
+                    // Drop the values of the invalid line.
+                    values.resize(rowStart);
+                    (*skipped)++;
+                } else {
+                    columns = lineColumns;
+                    rows++;
+                }
+            }
+
+            cursor = lineEnd + 1;
+        }
+
+        return true;
+    }
+
+    /*
+        * Parses the lines of a chunk into rows of comma-separated values.
+        *
+        * @param chunk: The chunk.
+    */
+    static void parseChunk(LoadChunk& chunk) {
+        chunk.failed = !parseRows(chunk.text, chunk.values, chunk.rows, chunk.columns);
+        std::string().swap(chunk.text);
+    }
+
+
+    Points loadPoints(const std::string& filePath, const bool weighted, const int threads, Reservoir* reservoir) {
+        std::unique_ptr<DatasetSource> source = openSource(filePath);
+
+        // Pipeline: one thread reads (and decompresses) chunks of whole lines, which are parsed by the other threads as tasks (and published to the reservoir).
+        std::vector<std::unique_ptr<LoadChunk>> chunks;
+        std::string readError;
+
+        #pragma omp parallel num_threads(threads)
+        #pragma omp single
+        {
+            std::string carry; // Partial last line of the previous chunk.
+            bool end = false;
+
+            while (!end) {
+                std::unique_ptr<LoadChunk> chunk = std::make_unique<LoadChunk>();
+                chunk->text.swap(carry);
+                const size_t begin = chunk->text.size();
+                chunk->text.resize(begin + LOAD_CHUNK);
+
+                size_t bytes = 0;
+                try {
+                    bytes = source->read(chunk->text.data() + begin, LOAD_CHUNK);
+                } catch (const std::runtime_error& error) {
+                    readError = error.what();
+                    break;
+                }
+                chunk->text.resize(begin + bytes);
+                end = bytes < LOAD_CHUNK;
+
+                // Carry the partial last line over to the next chunk.
+                if (!end) {
+                    const size_t lineEnd = chunk->text.rfind('\n');
+                    if (lineEnd != std::string::npos) {
+                        carry.assign(chunk->text, lineEnd + 1, std::string::npos);
+                        chunk->text.resize(lineEnd + 1);
+                    } else {
+                        carry.swap(chunk->text);
+                        continue;
+                    }
+                }
+
+                LoadChunk* parsed = chunk.get();
+                parsed->index = chunks.size();
+                chunks.push_back(std::move(chunk));
+
+                #pragma omp task firstprivate(parsed)
+                {
+                    parseChunk(*parsed);
+
+                    if (reservoir != nullptr && !parsed->failed) {
+                        reservoir->add(parsed->index, parsed->values.data(), parsed->rows, parsed->columns);
+                    }
+                }
+            }
+        }
+
+        if (!readError.empty()) {
+            throw std::runtime_error(readError);
+        }
+
+        // Offsets of the rows of the chunks.
+        std::vector<long long> offsets(chunks.size() + 1, 0);
+        int numColumns = 0;
+        for(size_t c = 0; c < chunks.size(); c++) {
+            if (chunks[c]->failed || (chunks[c]->rows > 0 && numColumns > 0 && chunks[c]->columns != numColumns)) {
+                throw std::runtime_error("ERROR: invalid line in file " + filePath);
+            }
+            if (chunks[c]->rows > 0) {
+                numColumns = chunks[c]->columns;
+            }
+            offsets[c + 1] = offsets[c] + chunks[c]->rows;
+        }
+
+        // Set N and dimensions based on the file content (the last column is the weight of weighted points).
+        const long long N = offsets.back(); // Number of points.
+        const int dimensions = weighted ? numColumns - 1 : numColumns; // Number of dimensions.
+
+        if (N == 0 || dimensions < 1) {
+            throw std::runtime_error("ERROR: no points in file " + filePath);
+        }
+
+        // Initialize points structure.
+        Points points(N, dimensions, new double[N * dimensions], new long long[N], new int[N], new double[N]);
+        points.firstTouch(threads);
+
+        // Scatter the rows of the chunks into the columns of the points.
+        #pragma omp parallel for schedule(dynamic) num_threads(threads)
+        for(size_t c = 0; c < chunks.size(); c++) {
+            const LoadChunk& chunk = *chunks[c];
+
+            for(long long r = 0; r < chunk.rows; r++) {
+                const long long i = offsets[c] + r;
+                const double* row = chunk.values.data() + r * numColumns;
+
+                for(int dim = 0; dim < dimensions; dim++) {
+                    points.coordinates[i + N * dim] = row[dim];
+                }
+                if (weighted) {
+                    points.weights[i] = row[dimensions];
+                }
+            }
+
+            std::vector<double>().swap(chunks[c]->values);
+        }
+
+        return points;
+    }
+
+    Centroids loadCentroids(const std::string& filePath, const int K, const int dimensions) {
+        const bool binary = filePath.size() >= 4 && filePath.compare(filePath.size() - 4, 4, ".bin") == 0;
+        std::ifstream file(filePath, std::ios::in | (binary ? std::ios::binary : std::ios::in));
+
+        if (!file.is_open()) {
+            throw std::runtime_error("ERROR: couldn't open file " + filePath);
+        }
+
+        Centroids centroids(K, dimensions, new double[K * dimensions], new int[K]);
+        int j = 0;
+
+        if (binary) {
+            // Header and rows of the centroids.
+            int header[2] = {0, 0};
+            file.read((char*) header, sizeof(header));
+            if (header[0] != K || header[1] != dimensions) {
+                throw std::runtime_error("ERROR: the centroids of " + filePath + " do not match the number of clusters and dimensions");
+            }
+
+            std::vector<double> row(dimensions);
+            for(; j < K && file.read((char*) row.data(), dimensions * sizeof(double)); j++) {
+                for(int dim = 0; dim < dimensions; dim++) {
+                    centroids.coordinates[j + K * dim] = row[dim];
+                }
+            }
+        } else {
+            std::string line, word;
+            for(; j < K && std::getline(file, line); j++) {
+                std::stringstream str(line);
+                int dim = 0;
+                while (dim < dimensions && getline(str, word, ',')) {
+                    centroids.coordinates[j + K * dim] = std::stod(word);
+                    dim++;
+                }
+
+                if (dim != dimensions || getline(str, word, ',')) {
+                    throw std::runtime_error("ERROR: the centroids of " + filePath + " do not match the number of clusters and dimensions");
+                }
+            }
+
+            // No centroid after the K-th one.
+            while (std::getline(file, line)) {
+                if (line.find_first_not_of(" \t\r") != std::string::npos) {
+                    throw std::runtime_error("ERROR: the centroids of " + filePath + " do not match the number of clusters and dimensions");
+                }
+            }
+        }
+
+        if (j != K) {
+            throw std::runtime_error("ERROR: the centroids of " + filePath + " do not match the number of clusters and dimensions");
+        }
+
+        for(j = 0; j < K; j++) {
+            centroids.clustersIds[j] = j;
+        }
+
+        return centroids;
+    }
+}
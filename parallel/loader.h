@@ -0,0 +1,52 @@
+#ifndef K_MEANS_PARALLEL_LOADER_H
+#define K_MEANS_PARALLEL_LOADER_H
+
+#include <string>
+#include <vector>
+
+#include "points.h"
+#include "centroids.h"
+#include "reservoir.h"
+
+
+namespace Parallel {
+  /*
+    * Loads the points from a dataset file (one point per line, comma-separated coordinates), decompressed on the fly if its extension is '.gz' or '.zst'.
+    * One thread reads (and decompresses) chunks of LOAD_CHUNK bytes of whole lines, which are parsed by the other threads as tasks,
+    * then the parsed rows are scattered into the columns of the points in parallel.
+    *
+    * @param filePath: Path of the file with the points.
+    * @param weighted: True if the last column of the file is the weight of the points.
+    * @param threads: Number of threads.
+    * @param reservoir: Sample of the rows fed with each parsed chunk, while the next chunks are loaded (disabled if null).
+    *
+    * @returns (Points) The points.
+  */
+  Points loadPoints(const std::string& filePath, const bool weighted, const int threads, Reservoir* reservoir = nullptr);
+
+  /*
+    * Parses lines of comma-separated values into rows (blank lines are skipped).
+    *
+    * @param text: Text of the lines (overwritten by the parser).
+    * @param values: Values of the rows, row-major (the rows are appended by the function).
+    * @param rows: Number of rows (incremented by the function).
+    * @param columns: Number of columns of the rows (set by the function from the first row if there are no rows yet, expected if positive when the invalid lines are skipped).
+    * @param skipped: Number of skipped invalid lines (incremented by the function), or null to stop at the first invalid line.
+    *
+    * @returns (bool) True if all the lines are rows of numbers with the same number of columns (always true when the invalid lines are skipped).
+  */
+  bool parseRows(std::string& text, std::vector<double>& values, long long& rows, int& columns, long long* skipped = nullptr);
+
+  /*
+    * Loads the centroids of a previous model from a file written by the writer (binary if the extension is '.bin', one centroid per line with comma-separated coordinates otherwise).
+    *
+    * @param filePath: Path of the file with the centroids.
+    * @param K: Number of clusters (the file must have K centroids).
+    * @param dimensions: Number of dimensions (the file must have centroids of these dimensions).
+    *
+    * @returns (Centroids) The centroids.
+  */
+  Centroids loadCentroids(const std::string& filePath, const int K, const int dimensions);
+}
+
+#endif // K_MEANS_PARALLEL_LOADER_H
@@ -0,0 +1,38 @@
+#ifndef K_MEANS_PARALLEL_METRICS_H
+#define K_MEANS_PARALLEL_METRICS_H
+
+#include <cmath>
+
+#include "options.h"
+
+
+namespace Parallel {
+  // Distance-metric policies of the assignment kernels (resolved at compile time, once per tile of points).
+  // The distance is the finished sum of the terms of each dimension.
+
+  // Squared Euclidean distance.
+  struct SquaredEuclidean {
+    static constexpr Metric metric = EUCLIDEAN;
+
+    static inline double term(const double x, const double c) { return (x - c) * (x - c); }
+    static inline double finish(const double sum) { return sum; }
+  };
+
+  // Cosine distance of unit vectors (the argmin is the argmax of the dot product).
+  struct Cosine {
+    static constexpr Metric metric = COSINE;
+
+    static inline double term(const double x, const double c) { return x * c; }
+    static inline double finish(const double sum) { return 1 - sum; }
+  };
+
+  // Manhattan distance.
+  struct Manhattan {
+    static constexpr Metric metric = MANHATTAN;
+
+    static inline double term(const double x, const double c) { return std::fabs(x - c); }
+    static inline double finish(const double sum) { return sum; }
+  };
+}
+
+#endif // K_MEANS_PARALLEL_METRICS_H
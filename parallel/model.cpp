@@ -0,0 +1,131 @@
+#include <cmath>
+#include <algorithm>
+#include <float.h>
+#include <omp.h>
+
+#include "model.h"
+#include "../params.h"
+
+
+namespace Parallel {
+    Model::Model(Centroids&& c, const Metric m, const double i, const int it, const int t) : centroids(std::move(c)), metric(m), inertia(i), iterations(it), threads(t), centroidsNorms(centroids.size, 0) {
+        const int K = centroids.size, dimensions = centroids.dimensions;
+
+        for(int dim = 0; dim < dimensions; dim++) {
+            for(int j = 0; j < K; j++) {
+                centroidsNorms[j] += centroids.coordinates[j + K * dim] * centroids.coordinates[j + K * dim];
+            }
+        }
+    }
+
+
+    void Model::predict(const double* coordinates, const long long size, int* labels, double* distances) const {
+        const long long numTiles = (size + POINT_TILE - 1) / POINT_TILE;
+
+        // Small batches are assigned by the calling thread (no team is started).
+        #pragma omp parallel for schedule(static) num_threads(threads) if(size >= PREDICT_GRAIN)
+        for(long long tile = 0; tile < numTiles; tile++) {
+            const long long begin = tile * POINT_TILE;
+            predictTile(coordinates, size, begin, std::min(size, begin + POINT_TILE), labels, distances);
+        }
+    }
+
+    void Model::predict(const Points& points, int* labels, double* distances) const {
+        predict(points.coordinates, points.size, labels, distances);
+    }
+
+
+    void Model::predictTile(const double* coordinates, const long long size, const long long begin, const long long end, int* labels, double* distances) const {
+        const int K = centroids.size, dimensions = centroids.dimensions;
+        const int tileSize = (int) (end - begin);
+
+        // Buffers of the tile (on the stack, so that a call does not allocate).
+        double minDistances[POINT_TILE];
+        double products[POINT_TILE];
+        int minClustersIds[POINT_TILE];
+
+        for(int p = 0; p < tileSize; p++) {
+            minDistances[p] = DBL_MAX;
+            minClustersIds[p] = -1;
+        }
+
+        for(int j = 0; j < K; j++) {
+            if (metric == MANHATTAN) {
+                // Sum of the absolute differences (no norm expansion).
+                for(int p = 0; p < tileSize; p++) {
+                    products[p] = 0;
+                }
+                for(int dim = 0; dim < dimensions; dim++) {
+                    const double* column = &coordinates[begin + size * dim];
+                    const double c = centroids.coordinates[j + K * dim];
+
+                    #pragma omp simd
+                    for(int p = 0; p < tileSize; p++) {
+                        products[p] += fabs(column[p] - c);
+                    }
+                }
+            } else {
+                // Dot products of the tile with the centroid, expanded with its norm (||x||^2 is common to all the centroids).
+                for(int p = 0; p < tileSize; p++) {
+                    products[p] = 0;
+                }
+                for(int dim = 0; dim < dimensions; dim++) {
+                    const double* column = &coordinates[begin + size * dim];
+                    const double c = centroids.coordinates[j + K * dim];
+
+                    #pragma omp simd
+                    for(int p = 0; p < tileSize; p++) {
+                        products[p] += column[p] * c;
+                    }
+                }
+
+                // The cosine distance only depends on the dot product with the normalized centroids.
+                const double norm = metric == COSINE ? 0 : centroidsNorms[j];
+                #pragma omp simd
+                for(int p = 0; p < tileSize; p++) {
+                    products[p] = norm - 2 * products[p];
+                }
+            }
+
+            for(int p = 0; p < tileSize; p++) {
+                if (products[p] < minDistances[p]) {
+                    minDistances[p] = products[p];
+                    minClustersIds[p] = j;
+                }
+            }
+        }
+
+        for(int p = 0; p < tileSize; p++) {
+            labels[begin + p] = minClustersIds[p];
+        }
+
+        if (distances == nullptr) {
+            return;
+        }
+
+        // Complete the distances with the norms of the points.
+        for(int p = 0; p < tileSize; p++) {
+            products[p] = 0;
+        }
+        if (metric != MANHATTAN) {
+            for(int dim = 0; dim < dimensions; dim++) {
+                const double* column = &coordinates[begin + size * dim];
+
+                #pragma omp simd
+                for(int p = 0; p < tileSize; p++) {
+                    products[p] += column[p] * column[p];
+                }
+            }
+        }
+
+        for(int p = 0; p < tileSize; p++) {
+            if (metric == EUCLIDEAN) {
+                distances[begin + p] = std::max(0.0, products[p] + minDistances[p]);
+            } else if (metric == COSINE) {
+                distances[begin + p] = products[p] > 0 ? 1 + minDistances[p] / (2 * sqrt(products[p])) : 1;
+            } else {
+                distances[begin + p] = minDistances[p];
+            }
+        }
+    }
+}
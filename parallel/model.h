@@ -0,0 +1,93 @@
+#ifndef K_MEANS_PARALLEL_MODEL_H
+#define K_MEANS_PARALLEL_MODEL_H
+
+#include <vector>
+
+#include "points.h"
+#include "centroids.h"
+#include "options.h"
+
+
+namespace Parallel {
+  // Fitted k-means model, with a batch assignment of new points that does not allocate.
+  class Model {
+    public:
+      /*
+        * Model constructor.
+        *
+        * @param centroids: The fitted centroids (moved into the model).
+        * @param metric: Distance metric of the fit.
+        * @param inertia: Weighted inertia of the fitted points.
+        * @param iterations: Number of iterations of the fit.
+        * @param threads: Maximum number of threads of the batch assignment.
+      */
+      Model(Centroids&& centroids, const Metric metric, const double inertia, const int iterations, const int threads);
+
+
+      /*
+        * Assigns a batch of points to the closest centroid (in parallel for the batches of at least PREDICT_GRAIN points).
+        * The points are read in the SoA layout of the points (x1, x2, ..., y1, y2, ...) and the outputs are written to the buffers of the caller.
+        *
+        * @param coordinates: Array of coordinates of the points (size * dimensions).
+        * @param size: Number of points of the batch.
+        * @param labels: Array of identifiers of the closest centroids (size).
+        * @param distances: Array of distances to the closest centroids (size, squared for the Euclidean metric), or null if not needed.
+      */
+      void predict(const double* coordinates, const long long size, int* labels, double* distances = nullptr) const;
+
+      /*
+        * Assigns points to the closest centroid.
+        *
+        * @param points: The points.
+        * @param labels: Array of identifiers of the closest centroids (points.size).
+        * @param distances: Array of distances to the closest centroids (points.size), or null if not needed.
+      */
+      void predict(const Points& points, int* labels, double* distances = nullptr) const;
+
+
+      /*
+        * Gets the fitted centroids.
+        *
+        * @returns (const Centroids&) The fitted centroids.
+      */
+      const Centroids& getCentroids() const { return centroids; }
+
+      /*
+        * Gets the weighted inertia of the fitted points.
+        *
+        * @returns (double) The weighted inertia of the fitted points.
+      */
+      double getInertia() const { return inertia; }
+
+      /*
+        * Gets the number of iterations of the fit.
+        *
+        * @returns (int) The number of iterations of the fit.
+      */
+      int getIterations() const { return iterations; }
+
+    private:
+      const Centroids centroids; // Fitted centroids.
+      const Metric metric; // Distance metric of the fit.
+      const double inertia; // Weighted inertia of the fitted points.
+      const int iterations; // Number of iterations of the fit.
+      const int threads; // Maximum number of threads of the batch assignment.
+
+      std::vector<double> centroidsNorms; // Squared norms of the centroids.
+
+
+      /*
+        * Assigns a tile of points to the closest centroid (dot products vectorized over the points, with the precomputed norms of the centroids).
+        *
+        * @param coordinates: Array of coordinates of the points.
+        * @param size: Number of points of the batch (stride of the coordinates).
+        * @param begin: Identifier of the first point of the tile.
+        * @param end: Identifier after the last point of the tile.
+        * @param labels: Array of identifiers of the closest centroids.
+        * @param distances: Array of distances to the closest centroids, or null.
+      */
+      void predictTile(const double* coordinates, const long long size, const long long begin, const long long end, int* labels, double* distances) const;
+  };
+}
+
+#endif // K_MEANS_PARALLEL_MODEL_H
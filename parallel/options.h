@@ -0,0 +1,139 @@
+#ifndef K_MEANS_PARALLEL_OPTIONS_H
+#define K_MEANS_PARALLEL_OPTIONS_H
+
+#include <string>
+
+#include "scheduler.h"
+#include "../params.h"
+
+
+namespace Parallel {
+  // Kernels for the assignment of the points to the closest centroid.
+  enum Engine {
+    NAIVE, // Distance of each point to each centroid.
+    TILED, // Distances of a tile of points to a tile of centroids, vectorized over the points.
+    IVF, // Approximate search in an inverted-file index over the centroids (rebuilt each iteration).
+    PROJECTED, // Shortlist of the closest centroids in a random-projection sketch, re-ranked with the exact distances.
+    NUM_ENGINES
+  };
+
+  // Names of the assignment kernels.
+  const char* const ENGINE_NAMES[NUM_ENGINES] = {"naive", "tiled", "ivf", "projected"};
+
+  // Configuration of the assignment kernel.
+  struct KernelConfig {
+    Engine engine = NAIVE; // Assignment kernel.
+    int pointTile = POINT_TILE; // Number of points of a tile.
+    int centroidTile = CENTROID_TILE; // Number of centroids of a tile (only with the tiled engine).
+    int threads = 0; // Number of threads (0 to use all the threads of the execution).
+  };
+
+  // Reduction of the partial sums of the clusters.
+  enum Reduction {
+    THREADS, // A partial for each thread, accumulated in the order the threads process the points.
+    DETERMINISTIC // A partial for each fixed-size block of points, reduced with a fixed pairwise tree (bit-identical for any number of threads).
+  };
+
+  // Distance metrics.
+  enum Metric {
+    EUCLIDEAN, // Squared Euclidean distance, mean update.
+    COSINE, // Cosine distance of the points normalized at load, normalized mean update (spherical k-means).
+    MANHATTAN, // Manhattan distance, weighted median update.
+    NUM_METRICS
+  };
+
+  // Names of the distance metrics.
+  const char* const METRIC_NAMES[NUM_METRICS] = {"euclidean", "cosine", "manhattan"};
+
+  // Precisions of the stored coordinates of the points.
+  enum Precision {
+    DOUBLE, // Double precision.
+    BF16, // Brain floating point (16 bits).
+    FP16, // IEEE half precision (16 bits).
+    INT8, // 8-bit integers with a per-dimension scale and offset.
+    NUM_PRECISIONS
+  };
+
+  // Names of the precisions.
+  const char* const PRECISION_NAMES[NUM_PRECISIONS] = {"double", "bf16", "fp16", "int8"};
+
+  // Orders of the points in memory.
+  enum Order {
+    INPUT_ORDER, // Order of the input (or generation).
+    MORTON, // Morton (Z-order) curve over a grid of the coordinates.
+    HILBERT, // Hilbert curve over a grid of the coordinates.
+    NUM_ORDERS
+  };
+
+  // Names of the orders of the points.
+  const char* const ORDER_NAMES[NUM_ORDERS] = {"input", "morton", "hilbert"};
+
+  // Formats of the output files of the labels and the centroids.
+  enum OutputFormat {
+    CSV_OUTPUT, // Text, one row per line with comma-separated values.
+    BINARY_OUTPUT, // Raw little-endian arrays (int32 labels, int32 header and float64 rows of the centroids).
+    NUM_OUTPUT_FORMATS
+  };
+
+  // Names of the output formats.
+  const char* const OUTPUT_FORMAT_NAMES[NUM_OUTPUT_FORMATS] = {"csv", "binary"};
+
+  // Criterion to share the budget of clusters between the halves of a split of the bisecting engine.
+  enum Bisection {
+    LARGEST, // Proportionally to the weight of the halves.
+    HIGHEST_SSE // Proportionally to the SSE of the halves.
+  };
+
+  // Optional settings of the parallel k-means execution.
+  struct Options {
+    bool weighted = false; // True if the last column of the input file is the weight of the points (the label with sparse points).
+    bool sparse = false; // True if the input file has sparse points in libsvm/svmlight format.
+    bool dedupe = false; // True if the points with identical coordinates should be collapsed into weighted points.
+    bool pipeline = false; // True if the seeding should sample the chunks of the input file while they are loaded.
+    Order order = INPUT_ORDER; // Order of the points in memory (sorted by a space-filling curve for locality).
+
+    Metric metric = EUCLIDEAN; // Distance metric.
+    Precision precision = DOUBLE; // Precision of the stored coordinates of the points in the iterations.
+
+    int coresetSize = 0; // Number of points of the coreset to cluster instead of all the points (disabled if 0).
+    bool coresetAssign = false; // True if the coreset clustering should be followed by an assignment pass over all the points.
+    bool coresetCompare = false; // True if the coreset clustering should be compared with the full Lloyd on the same points.
+
+    double multiresFraction = 0; // Fraction of the points of the first subsample stage of the multi-resolution solve (disabled if 0).
+
+    int sweepMaxK = 0; // Largest number of clusters of the K sweep starting at the number of clusters (disabled if 0).
+    int sweepStep = 1; // Step of the number of clusters of the K sweep.
+
+    bool bisecting = false; // True if the clusters should be found by bisecting k-means instead of the flat iterations.
+    Bisection bisection = HIGHEST_SSE; // Criterion to share the budget of clusters of the bisecting engine.
+    bool refine = false; // True if the bisecting clusters should be refined by the flat iterations.
+
+    KernelConfig kernel; // Configuration of the assignment kernel.
+    int lists = 0; // Number of lists of the centroid index (0 for the square root of K, only with the IVF engine).
+    int nprobe = IVF_NPROBE; // Number of lists scanned by a query of the centroid index (only with the IVF engine).
+    int sketchDimensions = SKETCH_DIMENSIONS; // Number of dimensions of the random-projection sketch (only with the projected engine).
+    int shortlist = SHORTLIST; // Number of centroids shortlisted in the sketch (only with the projected engine).
+    bool recallAudit = false; // True if the IVF assignment should be audited against the exact one on a sample of points (always with the projected engine).
+    bool autotune = false; // True if the kernel configuration should be tuned for the workload.
+    std::string tuningCache = TUNING_CACHE; // Path of the tuning cache file.
+    Schedule schedule = STEALING; // Scheduling of the assignment phase.
+    Reduction reduction = THREADS; // Reduction of the partial sums of the clusters.
+
+    bool profile = false; // True if the phases of each iteration should be profiled.
+    bool evaluate = false; // True if the quality of the clustering should be evaluated after the iterations.
+    std::string trace = ""; // Prefix of the JSON-lines metrics log and Chrome trace files (disabled if empty).
+
+    std::string checkpoint = ""; // Path of the checkpoint file of the iterations (disabled if empty).
+    int checkpointInterval = CHECKPOINT_INTERVAL; // Number of iterations between two checkpoints.
+    bool resume = false; // True if the iterations should resume from the checkpoint file (if it exists).
+    std::string initCentroids = ""; // Path of the file of the initial centroids of a previous model (seeded from the points if empty).
+
+    double streamDecay = STREAM_DECAY; // Decay of the weights of the centroids for each point of the streaming mode (in (0, 1]).
+    double snapshotInterval = SNAPSHOT_INTERVAL; // Number of seconds between two snapshots of the centroids of the streaming mode.
+
+    std::string output = ""; // Prefix of the files of the final labels and centroids (disabled if empty).
+    OutputFormat outputFormat = CSV_OUTPUT; // Format of the files of the final labels and centroids.
+  };
+}
+
+#endif // K_MEANS_PARALLEL_OPTIONS_H
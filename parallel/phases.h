@@ -0,0 +1,19 @@
+#ifndef K_MEANS_PARALLEL_PHASES_H
+#define K_MEANS_PARALLEL_PHASES_H
+
+
+namespace Parallel {
+  // Phases of a k-means iteration.
+  enum Phase {
+    ASSIGNMENT, // Assignment of the points to the closest centroid.
+    REDUCTION, // Reduction of the partial sums of the threads.
+    UPDATE, // Update of the centroids coordinates.
+    CONVERGENCE, // Check for convergence.
+    NUM_PHASES
+  };
+
+  // Names of the phases.
+  const char* const PHASE_NAMES[NUM_PHASES] = {"assignment", "reduction", "update", "convergence"};
+}
+
+#endif // K_MEANS_PARALLEL_PHASES_H
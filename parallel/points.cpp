@@ -1,12 +1,53 @@
+#include <algorithm>
+#include <omp.h>
+
 #include "points.h"
 
 
 namespace Parallel {
-    Points::Points(const int n, const int d, double* coords, int* pIds, int* cIds) : size(n), dimensions(d), coordinates(coords), pointsIds(pIds), clustersIds(cIds) { }
+    Points::Points(const long long n, const int d, double* coords, long long* pIds, int* cIds, double* w) : size(n), dimensions(d), coordinates(coords), pointsIds(pIds), clustersIds(cIds), weights(w) { }
+
+    Points::Points(Points&& other) : size(other.size), dimensions(other.dimensions), coordinates(other.coordinates), pointsIds(other.pointsIds), clustersIds(other.clustersIds), weights(other.weights) {
+        other.coordinates = nullptr;
+        other.pointsIds = nullptr;
+        other.clustersIds = nullptr;
+        other.weights = nullptr;
+    }
+
+    Points Points::copy() const {
+        Points other(size, dimensions, new double[(size_t) size * dimensions], new long long[size], new int[size], new double[size]);
+        std::copy(coordinates, coordinates + (size_t) size * dimensions, other.coordinates);
+        std::copy(pointsIds, pointsIds + size, other.pointsIds);
+        std::copy(clustersIds, clustersIds + size, other.clustersIds);
+        std::copy(weights, weights + size, other.weights);
+
+        return other;
+    }
+
+    void Points::swap(Points& other) {
+        std::swap(coordinates, other.coordinates);
+        std::swap(pointsIds, other.pointsIds);
+        std::swap(clustersIds, other.clustersIds);
+        std::swap(weights, other.weights);
+    }
+
+    void Points::firstTouch(const int threads) {
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for(long long i = 0; i < size; i++) {
+            for(int dim = 0; dim < dimensions; dim++) {
+                coordinates[i + size * dim] = 0;
+            }
+
+            pointsIds[i] = i;
+            clustersIds[i] = -1;
+            weights[i] = 1;
+        }
+    }
 
     Points::~Points() {
         delete[] coordinates;
         delete[] pointsIds;
         delete[] clustersIds;
+        delete[] weights;
     }
 }
\ No newline at end of file
@@ -5,12 +5,13 @@
 namespace Parallel {
   // Points in multidimensional space using SoA architecture.
   struct Points {
-    const int size; // Number of points.
+    const long long size; // Number of points.
     const int dimensions; // Number of dimensions.
     
     double* coordinates; // Array of coordinates of all dimensions (x1, x2, x3, ..., y1, y2, y3, ..., z1, z2, z3, ...).
-    int* pointsIds; // Array of points identifiers.
+    long long* pointsIds; // Array of points identifiers.
     int* clustersIds; // Array of clusters identifiers to which the points belong.
+    double* weights; // Array of points weights.
 
 
     /*
@@ -21,8 +22,42 @@ namespace Parallel {
       * @param coordinates: Array of points coordinates.
       * @param pointdIds: Array of points identifiers.
       * @param clustersIds: Array of clusters identifiers to which the points belong.
+      * @param weights: Array of points weights.
     */
-    Points(const int size, const int dimensions, double* coordinates, int* pointsIds, int* clustersIds);
+    Points(const long long size, const int dimensions, double* coordinates, long long* pointsIds, int* clustersIds, double* weights);
+
+    /*
+      * Points move constructor.
+      * 
+      * @param other: Points whose arrays are moved.
+    */
+    Points(Points&& other);
+
+    /*
+      * Points copy constructor (deleted since the arrays are owned).
+    */
+    Points(const Points& other) = delete;
+
+    /*
+      * Creates a copy of the points with its own arrays.
+      * 
+      * @returns (Points) The copy of the points.
+    */
+    Points copy() const;
+
+    /*
+      * Exchanges the arrays with other points of the same size and dimensions (e.g. to take back the points lent to a nested execution).
+      * 
+      * @param other: The other points.
+    */
+    void swap(Points& other);
+
+    /*
+      * Touches the arrays with the same static partition of the threads used for processing, so that the pages are placed on the NUMA node of the thread that processes them (first-touch policy).
+      * 
+      * @param threads: Number of threads.
+    */
+    void firstTouch(const int threads);
 
     /*
       * Points destructor.
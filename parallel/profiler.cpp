@@ -0,0 +1,178 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <omp.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+#include "profiler.h"
+#include "../params.h"
+
+
+namespace Parallel {
+    Profiler::Profiler(const bool e, const int t) : enabled(e), slots(e ? t : 0) { }
+
+    Profiler::~Profiler() {
+        #ifdef __linux__
+        for (ThreadSlot& slot : slots) {
+            if (slot.fd >= 0) {
+                close(slot.fd);
+            }
+        }
+        #endif
+    }
+
+
+    void Profiler::openCounters(ThreadSlot& slot) {
+        // Assume the counters are unavailable.
+        slot.fd = -1;
+
+        #ifdef __linux__
+        // Counters of the group (the first one is the group leader).
+        const unsigned long long configs[NUM_COUNTERS] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES
+        };
+
+        int fds[NUM_COUNTERS];
+        for (int c = 0; c < NUM_COUNTERS; c++) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = configs[c];
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+
+            // Count the calling thread on any CPU.
+            fds[c] = syscall(__NR_perf_event_open, &attr, 0, -1, c == 0 ? -1 : fds[0], 0);
+
+            if (fds[c] < 0) {
+                // Close the counters already opened.
+                for (int o = 0; o < c; o++) {
+                    close(fds[o]);
+                }
+                return;
+            }
+        }
+
+        // Only the group leader is kept, the members are read through it.
+        slot.fd = fds[0];
+        #endif
+    }
+
+
+    void Profiler::sample(double& time, long long* counters) {
+        ThreadSlot& slot = slots[omp_get_thread_num()];
+
+        if (slot.fd == -2) {
+            // Open the counters the first time the thread is sampled.
+            openCounters(slot);
+        }
+
+        #ifdef __linux__
+        if (slot.fd >= 0) {
+            // Read the group values (number of counters followed by the values).
+            unsigned long long values[1 + NUM_COUNTERS];
+            if (read(slot.fd, values, sizeof(values)) == sizeof(values)) {
+                for (int c = 0; c < NUM_COUNTERS; c++) {
+                    counters[c] = values[1 + c];
+                }
+            }
+        }
+        #endif
+
+        time = omp_get_wtime();
+    }
+
+    void Profiler::record(const Phase phase, const double time, const long long* counters) {
+        double endTime;
+        long long endCounters[NUM_COUNTERS] = {0};
+        sample(endTime, endCounters);
+
+        ThreadSlot& slot = slots[omp_get_thread_num()];
+        slot.time[phase] += endTime - time;
+        for (int c = 0; c < NUM_COUNTERS; c++) {
+            slot.counters[phase][c] += endCounters[c] - counters[c];
+        }
+    }
+
+
+    void Profiler::report(const int iterations, const long long N, const int K, const int dimensions) const {
+        if (!enabled || iterations == 0) {
+            return;
+        }
+
+        // Number of threads that took part in the execution.
+        int threads = 0;
+        bool countersAvailable = false;
+        for (const ThreadSlot& slot : slots) {
+            if (slot.fd != -2) {
+                threads++;
+            }
+            if (slot.fd >= 0) {
+                countersAvailable = true;
+            }
+        }
+
+        // Model of the floating point operations and compulsory bytes of each phase for a single iteration.
+        const double n = N, k = K, d = dimensions, t = threads;
+        const double flops[NUM_PHASES] = {n * k * 3 * d, t * k * (d + 1), k * d, 2 * k * d};
+        const double bytes[NUM_PHASES] = {n * (8 * d + 12), 8 * t * k * (d + 1), 3 * 8 * k * d, 2 * 8 * k * d};
+
+        std::cout << std::endl << "Profile of " << iterations << " iterations with #" << threads << " threads (" << (countersAvailable ? "hardware counters" : "hardware counters unavailable, bytes from model") << "):" << std::endl;
+        std::cout << std::left << std::setw(12) << "phase" << std::right
+                  << std::setw(11) << "time(s)" << std::setw(11) << "imbalance" << std::setw(8) << "IPC"
+                  << std::setw(13) << "bytes/point" << std::setw(10) << "GB/s" << std::setw(10) << "GFLOP/s"
+                  << std::setw(12) << "bound" << std::setw(10) << "limit" << std::endl;
+
+        for (int p = 0; p < NUM_PHASES; p++) {
+            // Critical path and mean time of the threads.
+            double maxTime = 0, sumTime = 0;
+            long long counters[NUM_COUNTERS] = {0};
+            for (const ThreadSlot& slot : slots) {
+                if (slot.fd == -2) continue;
+
+                maxTime = std::max(maxTime, slot.time[p]);
+                sumTime += slot.time[p];
+                for (int c = 0; c < NUM_COUNTERS; c++) {
+                    counters[c] += slot.counters[p][c];
+                }
+            }
+            const double imbalance = sumTime > 0 ? maxTime / (sumTime / threads) : 1;
+
+            // Bytes moved from memory (derived from the last level cache misses when available).
+            const double totalBytes = countersAvailable ? (double) counters[LLC_MISSES] * CACHE_LINE_SIZE : bytes[p] * iterations;
+            const double totalFlops = flops[p] * iterations;
+
+            // Roofline bound given by the arithmetic intensity of the phase.
+            const double intensity = totalBytes > 0 ? totalFlops / totalBytes : 0;
+            const double bound = std::min(PEAK_GFLOPS, intensity * PEAK_BANDWIDTH);
+
+            std::cout << std::left << std::setw(12) << PHASE_NAMES[p] << std::right << std::fixed
+                      << std::setw(11) << std::setprecision(6) << maxTime
+                      << std::setw(11) << std::setprecision(2) << imbalance;
+            if (countersAvailable && counters[CYCLES] > 0) {
+                std::cout << std::setw(8) << std::setprecision(2) << (double) counters[INSTRUCTIONS] / counters[CYCLES];
+            } else {
+                std::cout << std::setw(8) << "n/a";
+            }
+            std::cout << std::setw(13) << std::setprecision(2) << totalBytes / ((double) N * iterations)
+                      << std::setw(10) << std::setprecision(2) << (maxTime > 0 ? totalBytes / maxTime * 1e-9 : 0)
+                      << std::setw(10) << std::setprecision(2) << (maxTime > 0 ? totalFlops / maxTime * 1e-9 : 0)
+                      << std::setw(12) << std::setprecision(2) << bound
+                      << std::setw(10) << (intensity * PEAK_BANDWIDTH < PEAK_GFLOPS ? "memory" : "compute") << std::endl;
+            std::cout.unsetf(std::ios::fixed);
+        }
+        std::cout << std::setprecision(6) << std::endl;
+    }
+}
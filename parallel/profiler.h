@@ -0,0 +1,129 @@
+#ifndef K_MEANS_PARALLEL_PROFILER_H
+#define K_MEANS_PARALLEL_PROFILER_H
+
+#include <vector>
+#include <omp.h>
+
+#include "phases.h"
+#include "tracer.h"
+
+
+namespace Parallel {
+  // Hardware counters read through perf_event_open (where available).
+  enum Counter {
+    CYCLES, // CPU cycles.
+    INSTRUCTIONS, // Retired instructions.
+    LLC_MISSES, // Last level cache misses.
+    NUM_COUNTERS
+  };
+
+
+  // Per-thread profiler of the k-means iteration phases.
+  class Profiler {
+    public:
+      const bool enabled; // True if the profiler records the phases.
+
+
+      /*
+        * Profiler constructor.
+        *
+        * @param enabled: True if the profiler records the phases.
+        * @param threads: Maximum number of threads.
+      */
+      Profiler(const bool enabled, const int threads);
+
+      /*
+        * Profiler destructor (closes the hardware counters).
+      */
+      ~Profiler();
+
+
+      /*
+        * Reads the wall time and the hardware counters of the calling thread.
+        *
+        * @param time: The wall time.
+        * @param counters: Array of NUM_COUNTERS counters values.
+      */
+      void sample(double& time, long long* counters);
+
+      /*
+        * Accumulates a phase measurement of the calling thread.
+        *
+        * @param phase: The measured phase.
+        * @param time: The wall time at the beginning of the phase.
+        * @param counters: The counters values at the beginning of the phase.
+      */
+      void record(const Phase phase, const double time, const long long* counters);
+
+
+      /*
+        * Prints the summary table of the phases.
+        *
+        * @param iterations: Number of iterations.
+        * @param N: Number of points.
+        * @param K: Number of clusters.
+        * @param dimensions: Number of dimensions.
+      */
+      void report(const int iterations, const long long N, const int K, const int dimensions) const;
+
+    private:
+      // Measurements of a thread (aligned to avoid false sharing).
+      struct alignas(64) ThreadSlot {
+        int fd = -2; // File descriptor of the counters group (-2 if not opened, -1 if unavailable).
+        double time[NUM_PHASES] = {0}; // Wall time spent in each phase.
+        long long counters[NUM_PHASES][NUM_COUNTERS] = {{0}}; // Counters accumulated in each phase.
+      };
+
+      std::vector<ThreadSlot> slots; // Measurements of each thread.
+
+
+      /*
+        * Opens the hardware counters group of the calling thread.
+        *
+        * @param slot: The slot of the calling thread.
+      */
+      void openCounters(ThreadSlot& slot);
+  };
+
+
+  // Scoped measurement of a phase for the calling thread.
+  class ScopedPhase {
+    public:
+      /*
+        * ScopedPhase constructor (starts the measurement).
+        *
+        * @param profiler: The profiler.
+        * @param tracer: The tracer.
+        * @param phase: The measured phase.
+      */
+      ScopedPhase(Profiler& profiler, Tracer& tracer, const Phase phase) : profiler(profiler), tracer(tracer), phase(phase) {
+        if (profiler.enabled) {
+          profiler.sample(startTime, startCounters);
+        } else if (tracer.enabled) {
+          startTime = omp_get_wtime();
+        }
+      }
+
+      /*
+        * ScopedPhase destructor (stops the measurement).
+      */
+      ~ScopedPhase() {
+        if (profiler.enabled) {
+          profiler.record(phase, startTime, startCounters);
+        }
+        if (tracer.enabled) {
+          tracer.span(phase, omp_get_thread_num(), startTime, omp_get_wtime());
+        }
+      }
+
+    private:
+      Profiler& profiler; // The profiler.
+      Tracer& tracer; // The tracer.
+      const Phase phase; // The measured phase.
+
+      double startTime = 0; // Wall time at the beginning of the phase.
+      long long startCounters[NUM_COUNTERS] = {0}; // Counters at the beginning of the phase.
+  };
+}
+
+#endif // K_MEANS_PARALLEL_PROFILER_H
@@ -0,0 +1,147 @@
+#include <cmath>
+#include <cfloat>
+#include <random>
+#include <algorithm>
+#include <omp.h>
+
+#include "projection.h"
+#include "../params.h"
+
+
+namespace Parallel {
+    Projection::Projection(const int s, const int l) : sketchDimensions(std::max(1, std::min(MAX_SKETCH_DIMENSIONS, s))), shortlist(std::max(1, l)) { }
+
+
+    void Projection::build(const Points& points, const Centroids& centroids) {
+        const long long N = points.size;
+        const int K = centroids.size, dimensions = points.dimensions;
+        const int S = sketchDimensions;
+
+        #pragma omp single
+        {
+            if (matrix.empty()) {
+                // Gaussian projection matrix scaled to preserve the expected squared distances (with seed for reproducibility).
+                std::default_random_engine generator(SEED);
+                std::normal_distribution<double> normalDistribution(0, 1 / std::sqrt((double) S));
+                matrix.resize((size_t) dimensions * S);
+                for(double& value : matrix) {
+                    value = normalDistribution(generator);
+                }
+            }
+
+            centroidsSketch.assign((size_t) K * S, 0);
+
+            // The points are projected the first time only.
+            projectPoints = pointsSketch.empty();
+            if (projectPoints) {
+                pointsSketch.resize((size_t) N * S);
+            }
+
+            // Buffers of the threads.
+            scratch.resize(omp_get_num_threads());
+            for(Scratch& threadScratch : scratch) {
+                threadScratch.candidateDistances.resize(std::min(shortlist, K));
+                threadScratch.candidates.resize(std::min(shortlist, K));
+            }
+        }
+
+        if (projectPoints) {
+            // Project the points once per run, with a blocked multiply of the SoA coordinates (vectorized over the points of a block).
+            const long long numBlocks = (N + PROJECTION_BLOCK - 1) / PROJECTION_BLOCK;
+
+            #pragma omp for schedule(static)
+            for(long long block = 0; block < numBlocks; block++) {
+                const long long begin = block * PROJECTION_BLOCK;
+                const int size = (int) (std::min(N, begin + PROJECTION_BLOCK) - begin);
+
+                for(int s = 0; s < S; s++) {
+                    double* sketch = &pointsSketch[begin + (size_t) N * s];
+                    std::fill(sketch, sketch + size, 0.0);
+
+                    for(int dim = 0; dim < dimensions; dim++) {
+                        const double* coordinates = &points.coordinates[begin + (size_t) N * dim];
+                        const double value = matrix[(size_t) dim * S + s];
+
+                        #pragma omp simd
+                        for(int p = 0; p < size; p++) {
+                            sketch[p] += coordinates[p] * value;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Project the centroids.
+        #pragma omp for schedule(static)
+        for(int j = 0; j < K; j++) {
+            double* sketch = &centroidsSketch[(size_t) j * S];
+
+            for(int dim = 0; dim < dimensions; dim++) {
+                const double coordinate = centroids.coordinates[j + K * dim];
+                const double* row = &matrix[(size_t) dim * S];
+
+                #pragma omp simd
+                for(int s = 0; s < S; s++) {
+                    sketch[s] += coordinate * row[s];
+                }
+            }
+        }
+    }
+
+    void Projection::search(const Points& points, const Centroids& centroids, const long long pointId, int& id, double& distance) {
+        const long long N = points.size;
+        const int K = centroids.size, dimensions = points.dimensions;
+        const int S = sketchDimensions;
+
+        Scratch& threadScratch = scratch[omp_get_thread_num()];
+        double* candidateDistances = threadScratch.candidateDistances.data();
+        int* candidates = threadScratch.candidates.data();
+        const int numCandidates = threadScratch.candidates.size();
+
+        // Gather the sketch of the point.
+        double point[MAX_SKETCH_DIMENSIONS];
+        for(int s = 0; s < S; s++) {
+            point[s] = pointsSketch[pointId + (size_t) N * s];
+        }
+
+        // Shortlist the closest centroids in the sketch (insertion into the sorted candidates).
+        int count = 0;
+        for(int j = 0; j < K; j++) {
+            const double* sketch = &centroidsSketch[(size_t) j * S];
+            double sketchDistance = 0;
+            #pragma omp simd reduction(+:sketchDistance)
+            for(int s = 0; s < S; s++) {
+                sketchDistance += (sketch[s] - point[s]) * (sketch[s] - point[s]);
+            }
+
+            if (count < numCandidates || sketchDistance < candidateDistances[count - 1]) {
+                int position = count < numCandidates ? count++ : count - 1;
+                while (position > 0 && candidateDistances[position - 1] > sketchDistance) {
+                    candidateDistances[position] = candidateDistances[position - 1];
+                    candidates[position] = candidates[position - 1];
+                    position--;
+                }
+                candidateDistances[position] = sketchDistance;
+                candidates[position] = j;
+            }
+        }
+
+        // Re-rank the shortlist with the exact distances.
+        distance = DBL_MAX;
+        id = -1;
+        for(int c = 0; c < count; c++) {
+            const int j = candidates[c];
+            double exactDistance = 0;
+            for(int dim = 0; dim < dimensions; dim++) {
+                const double difference = centroids.coordinates[j + K * dim] - points.coordinates[pointId + (size_t) N * dim];
+                exactDistance += difference * difference;
+            }
+
+            // Ties are broken by the smallest identifier (as the exact engines).
+            if (exactDistance < distance || (exactDistance == distance && j < id)) {
+                distance = exactDistance;
+                id = j;
+            }
+        }
+    }
+}
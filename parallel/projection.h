@@ -0,0 +1,79 @@
+#ifndef K_MEANS_PARALLEL_PROJECTION_H
+#define K_MEANS_PARALLEL_PROJECTION_H
+
+#include <vector>
+
+#include "points.h"
+#include "centroids.h"
+
+
+namespace Parallel {
+  // Random-projection pre-filter of the closest centroid search.
+  // The points (once per run) and the centroids (once per iteration) are projected into a low-dimensional Gaussian sketch;
+  // a query shortlists the closest centroids in the sketch and re-ranks them with the exact distances.
+  class Projection {
+    public:
+      /*
+        * Projection constructor.
+        *
+        * @param sketchDimensions: Number of dimensions of the sketch (at most MAX_SKETCH_DIMENSIONS).
+        * @param shortlist: Number of centroids shortlisted in the sketch for the exact re-ranking.
+      */
+      Projection(const int sketchDimensions, const int shortlist);
+
+
+      /*
+        * Projects the centroids, and the points the first time (must be called by all the threads of a parallel region).
+        *
+        * @param points: The points.
+        * @param centroids: The centroids.
+      */
+      void build(const Points& points, const Centroids& centroids);
+
+      /*
+        * Searches the closest centroid of a point among the shortlist of the sketch (uses the scratch of the calling thread).
+        *
+        * @param points: The points.
+        * @param centroids: The centroids.
+        * @param pointId: Identifier of the point.
+        * @param id: Identifier of the closest shortlisted centroid.
+        * @param distance: Squared distance to the closest shortlisted centroid.
+      */
+      void search(const Points& points, const Centroids& centroids, const long long pointId, int& id, double& distance);
+
+
+      /*
+        * Gets the number of dimensions of the sketch.
+        *
+        * @returns (int) The number of dimensions of the sketch.
+      */
+      int getSketchDimensions() const { return sketchDimensions; }
+
+      /*
+        * Gets the number of shortlisted centroids.
+        *
+        * @returns (int) The number of shortlisted centroids.
+      */
+      int getShortlist() const { return shortlist; }
+
+    private:
+      // Buffers of a thread for the queries (aligned to avoid false sharing).
+      struct alignas(64) Scratch {
+        std::vector<double> candidateDistances; // Sketch squared distances to the shortlisted centroids (sorted).
+        std::vector<int> candidates; // Shortlisted centroids.
+      };
+
+      const int sketchDimensions; // Number of dimensions of the sketch.
+      const int shortlist; // Number of centroids shortlisted in the sketch.
+
+      bool projectPoints = false; // True while the points are projected (first build).
+
+      std::vector<double> matrix; // Projection matrix (dimensions x sketchDimensions, row-major).
+      std::vector<double> pointsSketch; // Sketch of the points (SoA, as the coordinates).
+      std::vector<double> centroidsSketch; // Sketch of the centroids (row-major).
+
+      std::vector<Scratch> scratch; // Buffers of each thread.
+  };
+}
+
+#endif // K_MEANS_PARALLEL_PROJECTION_H
@@ -0,0 +1,71 @@
+#include <cfloat>
+#include <algorithm>
+#include <omp.h>
+
+#include "quantized.h"
+
+
+namespace Parallel {
+    namespace {
+        /*
+            * Encodes the coordinates of the points with a storage policy.
+            *
+            * @param points: The points.
+            * @param quantized: The quantized coordinates (with the scales and offsets).
+            * @param values: Array of quantized coordinates.
+            * @param threads: Number of threads.
+        */
+        template <typename Storage>
+        void encode(const Points& points, const QuantizedPoints& quantized, typename Storage::Type* values, const int threads) {
+            const long long N = points.size;
+            const int dimensions = points.dimensions;
+
+            #pragma omp parallel for schedule(static) num_threads(threads)
+            for(long long i = 0; i < N; i++) {
+                for(int dim = 0; dim < dimensions; dim++) {
+                    values[i + N * dim] = Storage::encode(points.coordinates[i + N * dim], quantized.scales[dim], quantized.offsets[dim]);
+                }
+            }
+        }
+    }
+
+
+    QuantizedPoints quantize(const Points& points, const Precision precision, const int threads) {
+        const long long N = points.size;
+        const int dimensions = points.dimensions;
+
+        QuantizedPoints quantized;
+        quantized.size = N;
+        quantized.dimensions = dimensions;
+        quantized.precision = precision;
+        quantized.scales.assign(dimensions, 1);
+        quantized.offsets.assign(dimensions, 0);
+
+        if (precision == INT8) {
+            // Scale and offset of each dimension mapping its range to [-127, 127].
+            for(int dim = 0; dim < dimensions; dim++) {
+                double minValue = DBL_MAX, maxValue = -DBL_MAX;
+
+                #pragma omp parallel for schedule(static) num_threads(threads) reduction(min:minValue) reduction(max:maxValue)
+                for(long long i = 0; i < N; i++) {
+                    minValue = std::min(minValue, points.coordinates[i + N * dim]);
+                    maxValue = std::max(maxValue, points.coordinates[i + N * dim]);
+                }
+
+                quantized.offsets[dim] = (float) ((minValue + maxValue) / 2);
+                quantized.scales[dim] = (float) ((maxValue - minValue) / 254);
+            }
+
+            quantized.bytes.resize((size_t) N * dimensions);
+            encode<INT8Storage>(points, quantized, quantized.bytes.data(), threads);
+        } else if (precision == BF16) {
+            quantized.halves.resize((size_t) N * dimensions);
+            encode<BF16Storage>(points, quantized, quantized.halves.data(), threads);
+        } else if (precision == FP16) {
+            quantized.halves.resize((size_t) N * dimensions);
+            encode<FP16Storage>(points, quantized, quantized.halves.data(), threads);
+        }
+
+        return quantized;
+    }
+}
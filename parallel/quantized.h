@@ -0,0 +1,154 @@
+#ifndef K_MEANS_PARALLEL_QUANTIZED_H
+#define K_MEANS_PARALLEL_QUANTIZED_H
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#include "points.h"
+#include "options.h"
+
+
+namespace Parallel {
+  // Storage policies of the quantized coordinates (decoded to float in registers by the kernels).
+
+  // Brain floating point (upper 16 bits of a float).
+  struct BF16Storage {
+    typedef uint16_t Type;
+
+    static inline Type encode(const double x, const float, const float) {
+      const float value = (float) x;
+      uint32_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      // Round to nearest even.
+      bits += 0x7FFF + ((bits >> 16) & 1);
+      return (Type) (bits >> 16);
+    }
+
+    static inline float decode(const Type q, const float, const float) {
+      const uint32_t bits = (uint32_t) q << 16;
+      float value;
+      memcpy(&value, &bits, sizeof(value));
+      return value;
+    }
+  };
+
+  // IEEE half precision floating point.
+  struct FP16Storage {
+    typedef uint16_t Type;
+
+    static inline Type encode(const double x, const float, const float) {
+      #ifdef __FLT16_MAX__
+      const _Float16 value = (_Float16) x;
+      Type q;
+      memcpy(&q, &value, sizeof(q));
+      return q;
+      #else
+      const float value = (float) x;
+      uint32_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      const uint32_t sign = (bits >> 16) & 0x8000;
+      const int exponent = (int) ((bits >> 23) & 0xFF) - 127 + 15;
+      const uint32_t mantissa = bits & 0x7FFFFF;
+      if (exponent <= 0) {
+        // Subnormal or zero (rounded).
+        return exponent < -10 ? (Type) sign : (Type) (sign | (((mantissa | 0x800000) >> (14 - exponent)) + 1) >> 1);
+      } else if (exponent >= 31) {
+        // Overflow to infinity.
+        return (Type) (sign | 0x7C00);
+      }
+      // Round to nearest (the carry propagates into the exponent).
+      return (Type) (sign | (((exponent << 10) | (mantissa >> 13)) + ((mantissa >> 12) & 1)));
+      #endif
+    }
+
+    static inline float decode(const Type q, const float, const float) {
+      // Branch-free conversion (vectorizable): rebias the exponent, then fix the infinities, NaNs and subnormals with selects.
+      const float magic = 6.103515625e-05f; // 2^-14, the smallest normal half.
+      uint32_t bits = (uint32_t) (q & 0x7FFF) << 13;
+      const uint32_t exponent = bits & (0x7C00u << 13);
+      bits += (127 - 15) << 23;
+      bits += exponent == (0x7C00u << 13) ? (128 - 16) << 23 : 0;
+
+      uint32_t subnormalBits = bits + (1 << 23);
+      float subnormal;
+      memcpy(&subnormal, &subnormalBits, sizeof(subnormal));
+      subnormal -= magic;
+      memcpy(&subnormalBits, &subnormal, sizeof(subnormalBits));
+
+      bits = exponent == 0 ? subnormalBits : bits;
+      bits |= (uint32_t) (q & 0x8000) << 16;
+
+      float value;
+      memcpy(&value, &bits, sizeof(value));
+      return value;
+    }
+  };
+
+
+  // 8-bit integers with a per-dimension scale and offset.
+  struct INT8Storage {
+    typedef int8_t Type;
+
+    static inline Type encode(const double x, const float scale, const float offset) {
+      const double q = scale > 0 ? (x - offset) / scale : 0;
+      return (Type) (q < -127 ? -127 : (q > 127 ? 127 : (q < 0 ? q - 0.5 : q + 0.5)));
+    }
+
+    static inline float decode(const Type q, const float scale, const float offset) {
+      return q * scale + offset;
+    }
+  };
+
+
+  // Points coordinates stored with reduced precision using SoA architecture (the other arrays are shared with the points).
+  struct QuantizedPoints {
+    long long size = 0; // Number of points.
+    int dimensions = 0; // Number of dimensions.
+    Precision precision = DOUBLE; // Precision of the coordinates.
+
+    std::vector<uint16_t> halves; // Array of 16-bit coordinates of all dimensions (bf16 and fp16).
+    std::vector<int8_t> bytes; // Array of 8-bit coordinates of all dimensions (int8).
+    std::vector<float> scales; // Scale of each dimension (int8).
+    std::vector<float> offsets; // Offset of each dimension (int8).
+
+
+    /*
+      * Gets the number of bytes of the quantized coordinates.
+      *
+      * @returns (size_t) The number of bytes of the quantized coordinates.
+    */
+    size_t memory() const { return halves.size() * sizeof(uint16_t) + bytes.size() * sizeof(int8_t); }
+
+    /*
+      * Gets the array of quantized coordinates of a storage policy.
+      *
+      * @returns (const Storage::Type*) The array of quantized coordinates.
+    */
+    template <typename Storage>
+    const typename Storage::Type* data() const;
+  };
+
+  template <>
+  inline const uint16_t* QuantizedPoints::data<BF16Storage>() const { return halves.data(); }
+
+  template <>
+  inline const uint16_t* QuantizedPoints::data<FP16Storage>() const { return halves.data(); }
+
+  template <>
+  inline const int8_t* QuantizedPoints::data<INT8Storage>() const { return bytes.data(); }
+
+
+  /*
+    * Quantizes the coordinates of the points (in parallel over the points).
+    *
+    * @param points: The points.
+    * @param precision: Precision of the quantized coordinates.
+    * @param threads: Number of threads.
+    *
+    * @returns (QuantizedPoints) The quantized coordinates.
+  */
+  QuantizedPoints quantize(const Points& points, const Precision precision, const int threads);
+}
+
+#endif // K_MEANS_PARALLEL_QUANTIZED_H
@@ -0,0 +1,151 @@
+#include <cfloat>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include <omp.h>
+
+#include "reorder.h"
+
+
+namespace Parallel {
+    /*
+        * Maps the cell of a point to the transpose of its Hilbert index (Skilling's algorithm), in place.
+        *
+        * @param cell: Coordinates of the cell (bits per dimension each).
+        * @param bits: Number of bits per dimension.
+        * @param dimensions: Number of keyed dimensions.
+    */
+    static void hilbertTranspose(uint32_t* cell, const int bits, const int dimensions) {
+        const uint32_t highest = 1u << (bits - 1);
+
+        // Inverse undo of the rotations and reflections.
+        for(uint32_t q = highest; q > 1; q >>= 1) {
+            const uint32_t mask = q - 1;
+            for(int dim = 0; dim < dimensions; dim++) {
+                if (cell[dim] & q) {
+                    cell[0] ^= mask;
+                } else {
+                    const uint32_t swap = (cell[0] ^ cell[dim]) & mask;
+                    cell[0] ^= swap;
+                    cell[dim] ^= swap;
+                }
+            }
+        }
+
+        // Gray encoding.
+        for(int dim = 1; dim < dimensions; dim++) {
+            cell[dim] ^= cell[dim - 1];
+        }
+        uint32_t flip = 0;
+        for(uint32_t q = highest; q > 1; q >>= 1) {
+            if (cell[dimensions - 1] & q) {
+                flip ^= q - 1;
+            }
+        }
+        for(int dim = 0; dim < dimensions; dim++) {
+            cell[dim] ^= flip;
+        }
+    }
+
+
+    Points reorder(const Points& points, const Order order, std::vector<long long>& rowToPoint, const int threads) {
+        const long long N = points.size;
+        const int dimensions = points.dimensions;
+
+        // Keyed dimensions and bits per dimension of the 64-bit key.
+        const int keyed = std::min(dimensions, 64);
+        const int bits = std::max(1, std::min(32, 64 / keyed));
+        const double cells = (double) ((1ULL << bits) - 1);
+
+        // Range of each keyed dimension.
+        std::vector<double> minValues(keyed), scales(keyed);
+        for(int dim = 0; dim < keyed; dim++) {
+            double minValue = DBL_MAX, maxValue = -DBL_MAX;
+
+            #pragma omp parallel for schedule(static) num_threads(threads) reduction(min:minValue) reduction(max:maxValue)
+            for(long long i = 0; i < N; i++) {
+                minValue = std::min(minValue, points.coordinates[i + N * dim]);
+                maxValue = std::max(maxValue, points.coordinates[i + N * dim]);
+            }
+
+            minValues[dim] = minValue;
+            scales[dim] = maxValue > minValue ? cells / (maxValue - minValue) : 0;
+        }
+
+        // Keys of the points, sorted with a parallel merge sort (a sorted chunk per thread, merged with a pairwise tree).
+        std::vector<std::pair<uint64_t, long long>> keys(N);
+
+        #pragma omp parallel num_threads(threads)
+        {
+            std::vector<uint32_t> cell(keyed);
+
+            #pragma omp for schedule(static)
+            for(long long i = 0; i < N; i++) {
+                for(int dim = 0; dim < keyed; dim++) {
+                    cell[dim] = (uint32_t) ((points.coordinates[i + N * dim] - minValues[dim]) * scales[dim]);
+                }
+
+                if (order == HILBERT) {
+                    hilbertTranspose(cell.data(), bits, keyed);
+                }
+
+                // Interleave the bits of the dimensions (most significant first).
+                uint64_t key = 0;
+                for(int bit = bits - 1; bit >= 0; bit--) {
+                    for(int dim = 0; dim < keyed; dim++) {
+                        key = (key << 1) | ((cell[dim] >> bit) & 1);
+                    }
+                }
+                keys[i] = {key, i};
+            }
+
+            const int thread = omp_get_thread_num();
+            const int numThreads = omp_get_num_threads();
+            auto bound = [&keys, N, numThreads](const int chunk) { return keys.begin() + N * chunk / numThreads; };
+
+            std::sort(bound(thread), bound(thread + 1));
+
+            #pragma omp barrier
+
+            for(int width = 1; width < numThreads; width *= 2) {
+                #pragma omp for schedule(dynamic)
+                for(int chunk = 0; chunk < numThreads; chunk += 2 * width) {
+                    if (chunk + width < numThreads) {
+                        std::inplace_merge(bound(chunk), bound(chunk + width), bound(std::min(numThreads, chunk + 2 * width)));
+                    }
+                }
+            }
+        }
+
+        // Gather the points in key order.
+        Points reordered(N, dimensions, new double[(size_t) N * dimensions], new long long[N], new int[N], new double[N]);
+        reordered.firstTouch(threads);
+
+        std::vector<long long> positions(N);
+
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for(long long p = 0; p < N; p++) {
+            const long long i = keys[p].second;
+            for(int dim = 0; dim < dimensions; dim++) {
+                reordered.coordinates[p + N * dim] = points.coordinates[i + N * dim];
+            }
+            reordered.pointsIds[p] = points.pointsIds[i];
+            reordered.clustersIds[p] = -1;
+            reordered.weights[p] = points.weights[i];
+            positions[i] = p;
+        }
+
+        // Compose the map of the original points with the permutation.
+        if (rowToPoint.empty()) {
+            rowToPoint = std::move(positions);
+        } else {
+            #pragma omp parallel for schedule(static) num_threads(threads)
+            for(long long r = 0; r < (long long) rowToPoint.size(); r++) {
+                rowToPoint[r] = positions[rowToPoint[r]];
+            }
+        }
+
+        return reordered;
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef K_MEANS_PARALLEL_REORDER_H
+#define K_MEANS_PARALLEL_REORDER_H
+
+#include <vector>
+
+#include "points.h"
+#include "options.h"
+
+
+namespace Parallel {
+  /*
+    * Sorts the points by a space-filling curve key (parallel pre-pass), so that the points close in space are close in memory.
+    * The coordinates are quantized on a grid spanning the range of each dimension, with as many bits per dimension as fit in a 64-bit key
+    * (only the first 64 dimensions are keyed), and the ties are kept in point order.
+    *
+    * @param points: The points.
+    * @param order: Space-filling curve of the key (MORTON or HILBERT).
+    * @param rowToPoint: Vector mapping each original point to its point (composed with the reordering by the function, filled if empty).
+    * @param threads: Number of threads.
+    *
+    * @returns (Points) The reordered points (the identifier of a point is kept).
+  */
+  Points reorder(const Points& points, const Order order, std::vector<long long>& rowToPoint, const int threads);
+}
+
+#endif // K_MEANS_PARALLEL_REORDER_H
@@ -0,0 +1,65 @@
+#include <random>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "reservoir.h"
+
+
+namespace Parallel {
+    Reservoir::Reservoir(const int capacity, const int seed) : capacity(capacity), seed(seed) { }
+
+
+    void Reservoir::add(const long long chunk, const double* rows, const long long count, const int columns) {
+        if (capacity <= 0 || count == 0) {
+            return;
+        }
+
+        // Rows of the chunk with the smallest keys (max-heap of keys and rows, without holding the lock).
+        std::mt19937_64 generator((uint64_t) seed * 0x9E3779B97F4A7C15ULL + chunk);
+        std::vector<std::pair<uint64_t, long long>> candidates;
+        candidates.reserve(std::min<long long>(capacity, count));
+
+        for(long long r = 0; r < count; r++) {
+            const uint64_t key = generator();
+
+            if ((int) candidates.size() < capacity) {
+                candidates.emplace_back(key, r);
+                std::push_heap(candidates.begin(), candidates.end());
+            } else if (key < candidates.front().first) {
+                std::pop_heap(candidates.begin(), candidates.end());
+                candidates.back() = {key, r};
+                std::push_heap(candidates.begin(), candidates.end());
+            }
+        }
+
+        // Merge the candidates into the sample.
+        std::lock_guard<std::mutex> lock(mutex);
+        for(const std::pair<uint64_t, long long>& candidate : candidates) {
+            if ((int) heap.size() == capacity) {
+                if (candidate.first >= heap.front().key) continue;
+                std::pop_heap(heap.begin(), heap.end());
+                heap.pop_back();
+            }
+
+            const double* row = rows + candidate.second * columns;
+            heap.push_back({candidate.first, std::vector<double>(row, row + columns)});
+            std::push_heap(heap.begin(), heap.end());
+        }
+    }
+
+    std::vector<std::vector<double>> Reservoir::rows() {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::vector<Entry> sorted = heap;
+        std::sort(sorted.begin(), sorted.end());
+
+        std::vector<std::vector<double>> values;
+        values.reserve(sorted.size());
+        for(Entry& entry : sorted) {
+            values.push_back(std::move(entry.values));
+        }
+
+        return values;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef K_MEANS_PARALLEL_RESERVOIR_H
+#define K_MEANS_PARALLEL_RESERVOIR_H
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+
+namespace Parallel {
+  // Uniform sample without replacement of the rows of a dataset, fed concurrently with the chunks of rows as they are parsed.
+  // Each row draws a random key from the generator of its chunk and the sample keeps the rows with the smallest keys,
+  // so that it does not depend on the order in which the chunks are added (nor on the number of threads).
+  class Reservoir {
+    public:
+      /*
+        * Reservoir constructor.
+        *
+        * @param capacity: Number of sampled rows.
+        * @param seed: Seed of the generators of the chunks.
+      */
+      Reservoir(const int capacity, const int seed);
+
+
+      /*
+        * Adds the rows of a chunk to the sample (thread-safe).
+        *
+        * @param chunk: Index of the chunk in the dataset.
+        * @param rows: Values of the rows (row-major).
+        * @param count: Number of rows.
+        * @param columns: Number of columns of the rows.
+      */
+      void add(const long long chunk, const double* rows, const long long count, const int columns);
+
+      /*
+        * Returns the sampled rows, sorted by key (so that their order is reproducible).
+        *
+        * @returns (std::vector<std::vector<double>>) The sampled rows.
+      */
+      std::vector<std::vector<double>> rows();
+
+    private:
+      // Sampled row with its key.
+      struct Entry {
+        uint64_t key; // Random key of the row.
+        std::vector<double> values; // Values of the row.
+
+        bool operator<(const Entry& other) const { return key < other.key; }
+      };
+
+      const int capacity; // Number of sampled rows.
+      const int seed; // Seed of the generators of the chunks.
+
+      std::mutex mutex; // Mutex of the sample.
+      std::vector<Entry> heap; // Max-heap of the sampled rows by key.
+  };
+}
+
+#endif // K_MEANS_PARALLEL_RESERVOIR_H
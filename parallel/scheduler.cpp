@@ -0,0 +1,145 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+#include "scheduler.h"
+#include "../params.h"
+
+
+namespace Parallel {
+    WorkStealingPool::WorkStealingPool(const Schedule s, const int t) : schedule(s), maxThreads(t), ranges(t), ownersTime(t * t, 0) {
+        for (Range& range : ranges) {
+            omp_init_lock(&range.lock);
+            range.begin = 0;
+            range.end = 0;
+            range.owner = 0;
+            range.busyTime = 0;
+        }
+    }
+
+    WorkStealingPool::~WorkStealingPool() {
+        for (Range& range : ranges) {
+            omp_destroy_lock(&range.lock);
+        }
+    }
+
+
+    void WorkStealingPool::reset(const int units, const int threads) {
+        teamThreads = threads;
+
+        for (int t = 0; t < threads; t++) {
+            // Same contiguous partition of a static schedule (keeps the first-touch placement of the points).
+            ranges[t].begin = (int) ((long long) units * t / threads);
+            ranges[t].end = (int) ((long long) units * (t + 1) / threads);
+            ranges[t].owner = t;
+        }
+    }
+
+    bool WorkStealingPool::next(const int thread, int& begin, int& end, int& owner) {
+        Range& own = ranges[thread];
+
+        // Take a chunk from the front of the own range.
+        omp_set_lock(&own.lock);
+        const int remaining = own.end - own.begin;
+        if (remaining > 0) {
+            // Adaptive chunk size (large at the beginning, small towards the end to balance the threads).
+            const int chunk = schedule == STEALING ? std::max(MIN_CHUNK, remaining / CHUNK_DIVISOR) : remaining;
+
+            begin = own.begin;
+            end = std::min((int) own.end, begin + chunk);
+            owner = own.owner;
+            own.begin = end;
+
+            omp_unset_lock(&own.lock);
+            return true;
+        }
+        omp_unset_lock(&own.lock);
+
+        if (schedule == STATIC) {
+            return false;
+        }
+
+        while (true) {
+            // Select the victim with most remaining units.
+            int victim = -1, most = 0;
+            for (int t = 0; t < teamThreads; t++) {
+                const int units = ranges[t].end - ranges[t].begin;
+                if (t != thread && units > most) {
+                    victim = t;
+                    most = units;
+                }
+            }
+
+            if (victim < 0) {
+                // All the units have been taken.
+                return false;
+            }
+
+            // Steal the back half of the victim range.
+            Range& other = ranges[victim];
+            omp_set_lock(&other.lock);
+            const int units = other.end - other.begin;
+            if (units <= 0) {
+                // The victim ran out in the meantime.
+                omp_unset_lock(&other.lock);
+                continue;
+            }
+            const int stolenEnd = other.end;
+            const int stolenBegin = stolenEnd - (units + 1) / 2;
+            const int stolenOwner = other.owner;
+            other.end = stolenBegin;
+            omp_unset_lock(&other.lock);
+
+            // Take the first chunk of the stolen units and keep the rest in the own range.
+            const int chunk = std::max(MIN_CHUNK, (stolenEnd - stolenBegin) / CHUNK_DIVISOR);
+
+            omp_set_lock(&own.lock);
+            begin = stolenBegin;
+            end = std::min(stolenEnd, begin + chunk);
+            owner = stolenOwner;
+            own.begin = end;
+            own.end = stolenEnd;
+            own.owner = stolenOwner;
+            omp_unset_lock(&own.lock);
+
+            return true;
+        }
+    }
+
+    void WorkStealingPool::account(const int thread, const int owner, const double time) {
+        ranges[thread].busyTime += time;
+        ownersTime[thread * maxThreads + owner] += time;
+    }
+
+
+    void WorkStealingPool::report() const {
+        if (teamThreads == 0) {
+            return;
+        }
+
+        // Time spent by each thread and time of the chunks of each owner (i.e. the time of each thread with a static schedule).
+        double maxBusy = 0, sumBusy = 0, maxOwner = 0, sumOwner = 0;
+        for (int t = 0; t < teamThreads; t++) {
+            double ownerTime = 0;
+            for (int e = 0; e < maxThreads; e++) {
+                ownerTime += ownersTime[e * maxThreads + t];
+            }
+
+            maxBusy = std::max(maxBusy, ranges[t].busyTime);
+            sumBusy += ranges[t].busyTime;
+            maxOwner = std::max(maxOwner, ownerTime);
+            sumOwner += ownerTime;
+        }
+
+        const double imbalance = sumBusy > 0 ? maxBusy / (sumBusy / teamThreads) : 1;
+        const double staticImbalance = sumOwner > 0 ? maxOwner / (sumOwner / teamThreads) : 1;
+
+        if (schedule == STEALING) {
+            std::cout << "Assignment imbalance (max/mean thread time): " << std::fixed << std::setprecision(3) << imbalance << " with work stealing, " << staticImbalance << " estimated with static scheduling." << std::endl;
+        } else {
+            std::cout << "Assignment imbalance (max/mean thread time): " << std::fixed << std::setprecision(3) << imbalance << " with static scheduling." << std::endl;
+        }
+        std::cout.unsetf(std::ios::fixed);
+        std::cout << std::setprecision(6);
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef K_MEANS_PARALLEL_SCHEDULER_H
+#define K_MEANS_PARALLEL_SCHEDULER_H
+
+#include <vector>
+#include <atomic>
+#include <omp.h>
+
+
+namespace Parallel {
+  // Scheduling of the assignment phase.
+  enum Schedule {
+    STATIC, // Each thread processes its contiguous range of units.
+    STEALING // Each thread takes adaptive chunks of its range and steals from the other threads when it runs out.
+  };
+
+
+  // Pool of units of work (e.g. blocks of points) with locality-preserving ownership and work stealing.
+  class WorkStealingPool {
+    public:
+      /*
+        * WorkStealingPool constructor.
+        *
+        * @param schedule: The scheduling of the units.
+        * @param threads: Maximum number of threads.
+      */
+      WorkStealingPool(const Schedule schedule, const int threads);
+
+      /*
+        * WorkStealingPool destructor.
+      */
+      ~WorkStealingPool();
+
+
+      /*
+        * Partitions the units into contiguous ranges owned by the threads (as a static schedule). It must be called by a single thread.
+        *
+        * @param units: Number of units.
+        * @param threads: Number of threads of the team.
+      */
+      void reset(const int units, const int threads);
+
+      /*
+        * Takes the next chunk of units for a thread.
+        *
+        * @param thread: The identifier of the thread.
+        * @param begin: The first unit of the chunk.
+        * @param end: The unit after the last one of the chunk.
+        * @param owner: The thread owning the chunk in the static partition.
+        *
+        * @returns (bool) True if a chunk was taken, false if all the units have been taken.
+      */
+      bool next(const int thread, int& begin, int& end, int& owner);
+
+      /*
+        * Accounts the execution time of a chunk.
+        *
+        * @param thread: The identifier of the thread that executed the chunk.
+        * @param owner: The thread owning the chunk in the static partition.
+        * @param time: The execution time of the chunk.
+      */
+      void account(const int thread, const int owner, const double time);
+
+
+      /*
+        * Prints the imbalance (maximum over mean thread time) of the run and the one estimated for a static schedule.
+      */
+      void report() const;
+
+    private:
+      // Range of units of a thread (aligned to avoid false sharing).
+      struct alignas(64) Range {
+        omp_lock_t lock; // Lock for the updates of the range.
+        std::atomic<int> begin; // First unit of the range.
+        std::atomic<int> end; // Unit after the last one of the range.
+        int owner; // Thread owning the range in the static partition.
+
+        double busyTime; // Time spent by the thread executing chunks.
+      };
+
+      const Schedule schedule; // The scheduling of the units.
+      const int maxThreads; // Maximum number of threads.
+      int teamThreads = 0; // Number of threads of the team.
+
+      std::vector<Range> ranges; // Ranges of the threads.
+      std::vector<double> ownersTime; // Execution time of the chunks of each owner accounted by each thread (threads x owners).
+  };
+}
+
+#endif // K_MEANS_PARALLEL_SCHEDULER_H
@@ -0,0 +1,267 @@
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <omp.h>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "server.h"
+#include "loader.h"
+#include "kmeans.h"
+#include "../params.h"
+
+
+namespace Parallel {
+    /*
+        * Sends a message on a socket (ignoring a closed peer).
+        *
+        * @param socket: The socket.
+        * @param message: The message.
+    */
+    static void sendAll(const int socket, const std::string& message) {
+        size_t sent = 0;
+        while (sent < message.size()) {
+            const ssize_t count = send(socket, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+            if (count <= 0) {
+                return;
+            }
+            sent += count;
+        }
+    }
+
+    /*
+        * Receives the messages of a socket until the peer stops sending.
+        *
+        * @param socket: The socket.
+        * @param message: The received bytes (filled by the function).
+        *
+        * @returns (bool) True if the peer stopped sending, false if the reception failed or timed out.
+    */
+    static bool receiveAll(const int socket, std::string& message) {
+        char buffer[4096];
+        ssize_t count;
+        while ((count = recv(socket, buffer, sizeof(buffer), 0)) > 0) {
+            message.append(buffer, count);
+        }
+
+        return count == 0;
+    }
+
+    /*
+        * Fills the address of a Unix domain socket.
+        *
+        * @param socketPath: Path of the socket.
+        * @param address: The address (filled by the function).
+    */
+    static void socketAddress(const std::string& socketPath, sockaddr_un& address) {
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            throw std::runtime_error("ERROR: socket path too long");
+        }
+
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    }
+
+
+    DatasetCache::DatasetCache(const long long c) : capacity(c) { }
+
+    std::shared_ptr<const Points> DatasetCache::get(const std::string& filePath, const bool weighted, const int threads, bool& hit) {
+        const std::string key = filePath + (weighted ? "|weighted" : "");
+
+        struct stat status;
+        if (stat(filePath.c_str(), &status) != 0) {
+            throw std::runtime_error("ERROR: couldn't open file");
+        }
+        const long long modified = status.st_mtim.tv_sec * 1000000000LL + status.st_mtim.tv_nsec;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            for (auto entry = entries.begin(); entry != entries.end(); ++entry) {
+                if (entry->key != key) continue;
+
+                if (entry->modified == modified) {
+                    // Move the entry to the front (most recently used).
+                    entries.splice(entries.begin(), entries, entry);
+                    hit = true;
+                    return entries.front().points;
+                }
+
+                // The file was modified since it was loaded.
+                bytes -= entry->bytes;
+                entries.erase(entry);
+                break;
+            }
+        }
+
+        // Load the points without holding the lock (the cached datasets stay available to the other jobs).
+        hit = false;
+        std::shared_ptr<const Points> points = std::make_shared<const Points>(loadPoints(filePath, weighted, threads));
+        const long long pointsBytes = points->size * ((long long) points->dimensions * sizeof(double) + sizeof(long long) + sizeof(int) + sizeof(double));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.push_front({key, modified, pointsBytes, points});
+        bytes += pointsBytes;
+
+        // Evict the least recently used datasets beyond the capacity.
+        while (bytes > capacity && entries.size() > 1) {
+            bytes -= entries.back().bytes;
+            entries.pop_back();
+        }
+
+        return points;
+    }
+
+
+    Server::Server(const std::string& s, const int t, const std::function<bool(const std::vector<std::string>&, Job&)>& p) : socketPath(s), threads(std::max(1, t)), parse(p), cache(DATASET_CACHE_MEMORY), availableThreads(threads) { }
+
+    void Server::serve() {
+        sockaddr_un address;
+        socketAddress(socketPath, address);
+
+        const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(socketPath.c_str());
+        if (listener < 0 || bind(listener, (sockaddr*) &address, sizeof(address)) != 0 || listen(listener, SERVER_BACKLOG) != 0) {
+            throw std::runtime_error("ERROR: couldn't listen on socket " + socketPath);
+        }
+
+        // Persistent workers (at most one job per thread of the budget).
+        for (int w = 0; w < threads; w++) {
+            workers.emplace_back(&Server::work, this);
+        }
+
+        std::cout << "Listening on " << socketPath << " with a budget of #" << threads << " threads." << std::endl;
+
+        // Maximum wait of the accept thread for the arguments of a client (a stalled client can't block the other clients).
+        const timeval receiveTimeout = {SERVER_RECEIVE_TIMEOUT, 0};
+
+        int client;
+        while ((client = accept(listener, nullptr, nullptr)) >= 0) {
+            // Arguments of the job (separated by '\0').
+            std::string message;
+            if (setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &receiveTimeout, sizeof(receiveTimeout)) != 0 || !receiveAll(client, message)) {
+                sendAll(client, "ERROR couldn't receive the job (send the arguments and close the sending side within " + std::to_string(SERVER_RECEIVE_TIMEOUT) + " seconds)\n");
+                close(client);
+                continue;
+            }
+
+            std::vector<std::string> arguments;
+            for (size_t begin = 0; begin < message.size(); ) {
+                size_t end = message.find('\0', begin);
+                if (end == std::string::npos) {
+                    end = message.size();
+                }
+                arguments.push_back(message.substr(begin, end - begin));
+                begin = end + 1;
+            }
+
+            Request request = {client, Job()};
+            if (!parse(arguments, request.job)) {
+                sendAll(client, "ERROR invalid job (use '--input_mode=input' and '--execution_type=parallel' with the required parameters)\n");
+                close(client);
+                continue;
+            }
+            request.job.threads = std::max(1, std::min(threads, request.job.threads));
+
+            // Queue the job.
+            {
+                std::lock_guard<std::mutex> lock(requestsMutex);
+                requests.push_back(std::move(request));
+            }
+            requestsCondition.notify_one();
+        }
+
+        close(listener);
+        throw std::runtime_error("ERROR: couldn't accept on socket " + socketPath);
+    }
+
+    void Server::work() {
+        while (true) {
+            // Wait for a job.
+            std::unique_lock<std::mutex> requestsLock(requestsMutex);
+            requestsCondition.wait(requestsLock, [this] { return !requests.empty(); });
+            Request request = std::move(requests.front());
+            requests.pop_front();
+            requestsLock.unlock();
+
+            // Reserve the threads of the job.
+            {
+                std::unique_lock<std::mutex> budgetLock(budgetMutex);
+                budgetCondition.wait(budgetLock, [this, &request] { return availableThreads >= request.job.threads; });
+                availableThreads -= request.job.threads;
+            }
+
+            run(request);
+            close(request.client);
+
+            // Release the threads of the job.
+            {
+                std::lock_guard<std::mutex> budgetLock(budgetMutex);
+                availableThreads += request.job.threads;
+            }
+            budgetCondition.notify_all();
+        }
+    }
+
+    void Server::run(Request& request) {
+        const Job& job = request.job;
+        std::ostringstream report;
+
+        try {
+            const double startTime = omp_get_wtime();
+
+            // Get the points from the cache (or load them).
+            bool hit;
+            std::shared_ptr<const Points> dataset = cache.get(job.filePath, job.options.weighted, job.threads, hit);
+            const double loadTime = omp_get_wtime() - startTime;
+
+            // Cluster a copy of the points (the pre-passes of the job modify them).
+            KMeans kmeans(dataset->copy(), job.K, job.threads, job.options);
+            const Model model = kmeans.fit();
+
+            report << "OK points=" << dataset->size << " clusters=" << model.getCentroids().size << " threads=" << job.threads << " iterations=" << model.getIterations() << " inertia=" << model.getInertia()
+                   << " dataset=" << (hit ? "cached" : "loaded") << " load_time=" << loadTime << " time=" << omp_get_wtime() - startTime << std::endl;
+        } catch (const std::exception& error) {
+            report << error.what() << std::endl;
+        }
+
+        std::cout << "Job on " << job.filePath << ": " << report.str();
+        sendAll(request.client, report.str());
+    }
+
+
+    int submit(const std::string& socketPath, const std::vector<std::string>& arguments) {
+        sockaddr_un address;
+        socketAddress(socketPath, address);
+
+        const int server = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (server < 0 || connect(server, (sockaddr*) &address, sizeof(address)) != 0) {
+            std::cout << "ERROR: couldn't connect to socket " << socketPath << std::endl;
+            return 1;
+        }
+
+        // Send the arguments (separated by '\0') and close the sending side.
+        std::string message;
+        for (const std::string& argument : arguments) {
+            message += argument;
+            message += '\0';
+        }
+        sendAll(server, message);
+        shutdown(server, SHUT_WR);
+
+        // Print the report of the job.
+        std::string report;
+        receiveAll(server, report);
+        close(server);
+        std::cout << report;
+
+        return report.compare(0, 2, "OK") == 0 ? 0 : 1;
+    }
+}
@@ -0,0 +1,136 @@
+#ifndef K_MEANS_PARALLEL_SERVER_H
+#define K_MEANS_PARALLEL_SERVER_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+#include "points.h"
+#include "options.h"
+
+
+namespace Parallel {
+  // Clustering job submitted to the server.
+  struct Job {
+    std::string filePath; // Path of the file with the points.
+    int K = 0; // Number of clusters.
+    int threads = 1; // Number of threads of the job (bounded by the threads of the server).
+    Options options; // Optional settings of the execution.
+  };
+
+
+  // LRU cache of the loaded datasets, keyed by path and modification time.
+  class DatasetCache {
+    public:
+      /*
+        * DatasetCache constructor.
+        *
+        * @param capacity: Maximum memory (in bytes) of the cached points (the last loaded dataset is always kept).
+      */
+      DatasetCache(const long long capacity);
+
+
+      /*
+        * Gets the points of a dataset file, loading them if they are not cached or the file was modified.
+        *
+        * @param filePath: Path of the file with the points.
+        * @param weighted: True if the last column of the file is the weight of the points.
+        * @param threads: Number of threads of the loading.
+        * @param hit: True if the points were cached (set by the function).
+        *
+        * @returns (std::shared_ptr<const Points>) The points (kept alive while in use, even if evicted).
+      */
+      std::shared_ptr<const Points> get(const std::string& filePath, const bool weighted, const int threads, bool& hit);
+
+    private:
+      // Cached dataset.
+      struct Entry {
+        std::string key; // Path of the file (and weighted flag).
+        long long modified; // Modification time of the file (nanoseconds).
+        long long bytes; // Memory of the points.
+        std::shared_ptr<const Points> points; // The points.
+      };
+
+      const long long capacity; // Maximum memory of the cached points.
+      long long bytes = 0; // Memory of the cached points.
+      std::list<Entry> entries; // Cached datasets (most recently used first).
+      std::mutex mutex; // Lock of the entries.
+  };
+
+
+  // Long-running clustering server on a Unix domain socket.
+  // Each connection submits the command-line arguments of a job (separated by '\0') and receives a one-line report.
+  // The jobs run on persistent workers (keeping their OpenMP teams warm) within a total budget of threads.
+  class Server {
+    public:
+      /*
+        * Server constructor.
+        *
+        * @param socketPath: Path of the Unix domain socket.
+        * @param threads: Total number of threads of the running jobs.
+        * @param parse: Parser of the arguments of a job (returns false if they are invalid).
+      */
+      Server(const std::string& socketPath, const int threads, const std::function<bool(const std::vector<std::string>&, Job&)>& parse);
+
+
+      /*
+        * Listens on the socket and runs the submitted jobs (does not return unless the socket fails).
+      */
+      void serve();
+
+    private:
+      // Job waiting for a worker.
+      struct Request {
+        int client; // Socket of the client.
+        Job job; // The job.
+      };
+
+      const std::string socketPath; // Path of the Unix domain socket.
+      const int threads; // Total number of threads of the running jobs.
+      const std::function<bool(const std::vector<std::string>&, Job&)> parse; // Parser of the arguments of a job.
+
+      DatasetCache cache; // Cache of the loaded datasets.
+
+      std::deque<Request> requests; // Jobs waiting for a worker.
+      std::mutex requestsMutex; // Lock of the requests.
+      std::condition_variable requestsCondition; // Signaled when a job is queued.
+
+      int availableThreads; // Threads of the budget not used by the running jobs.
+      std::mutex budgetMutex; // Lock of the budget.
+      std::condition_variable budgetCondition; // Signaled when a job releases its threads.
+
+      std::vector<std::thread> workers; // Persistent workers.
+
+
+      /*
+        * Runs the queued jobs (loop of a worker).
+      */
+      void work();
+
+      /*
+        * Runs a job and sends its report to the client.
+        *
+        * @param request: The job and the socket of its client.
+      */
+      void run(Request& request);
+  };
+
+
+  /*
+    * Submits the arguments of a job to a server and prints its report.
+    *
+    * @param socketPath: Path of the Unix domain socket of the server.
+    * @param arguments: Command-line arguments of the job.
+    *
+    * @returns (int) 0 if the job succeeded, 1 otherwise.
+  */
+  int submit(const std::string& socketPath, const std::vector<std::string>& arguments);
+}
+
+#endif // K_MEANS_PARALLEL_SERVER_H
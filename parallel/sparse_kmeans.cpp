@@ -0,0 +1,344 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cfloat>
+#include <climits>
+#include <random>
+#include <set>
+#include <algorithm>
+#include <omp.h>
+
+#include "sparse_kmeans.h"
+#include "writer.h"
+#include "../utils.h"
+#include "../params.h"
+
+
+namespace Parallel {
+    SparseKMeans::SparseKMeans(const std::string& filePath, const int k, const int t, const Options& o) : filePath(filePath), K(k), threads(t), options(checkOptions(o)), points(initializeInputPoints()), centroids(initializeCentroids()) { }
+
+
+    void SparseKMeans::run(const std::string &basePath, const bool log) {
+        // Set the number of threads.
+        omp_set_num_threads(threads);
+
+        std::cout << "Running parallel sparse k-means with " << N << " points (" << dimensions << " dimensions, " << 100.0 * points.nonZeros / ((double) N * dimensions) << "% density) and " << K << " clusters using #" << omp_get_max_threads() << " threads." << std::endl;
+
+        if (log) {
+            std::cout << "LOG is disabled for sparse points." << std::endl;
+        }
+
+        // Create the folders for the results.
+        FolderPaths paths = create_folders(basePath, "parallel", N, K, dimensions, false);
+
+        // Variables for convergence.
+        int iterations = 0;
+        bool converged = false;
+
+        // Variables for execution times and inertia.
+        double executionTimes = 0;
+        double inertia = 0;
+
+        while (iterations < MAX_ITERATIONS && !converged) {
+            // Start the timer.
+            double startTime = omp_get_wtime();
+
+            // Execute the iteration and check if the centroids have changed.
+            long long moved = 0;
+            converged = KMeansIteration(moved, inertia);
+
+            // Stop the timer.
+            executionTimes += omp_get_wtime() - startTime;
+
+            iterations++;
+        }
+
+        std::cout << "Converged after " << iterations << " iterations in " << executionTimes << " seconds (inertia " << inertia << ")." << std::endl;
+
+        if (!options.output.empty()) {
+            // Write the final labels and centroids.
+            const double startTime = omp_get_wtime();
+            const std::string extension = options.outputFormat == CSV_OUTPUT ? ".csv" : ".bin";
+            writeLabels(options.output + ".labels" + extension, points.clustersIds, nullptr, N, options.outputFormat, threads);
+            writeCentroids(options.output + ".centroids" + extension, centroids, options.outputFormat, threads);
+
+            std::cout << "Wrote the labels of " << N << " points and " << K << " centroids (" << OUTPUT_FORMAT_NAMES[options.outputFormat] << ") to " << options.output << ".* in " << omp_get_wtime() - startTime << " seconds." << std::endl;
+        }
+
+        // Save the results.
+        save_results(iterations, executionTimes, paths, "parallel", N, K, dimensions);
+    }
+
+
+    const Options& SparseKMeans::checkOptions(const Options& options) {
+        const Options defaults;
+
+        if (options.metric != EUCLIDEAN || options.precision != DOUBLE || options.kernel.engine != NAIVE || options.autotune || options.recallAudit || options.schedule != defaults.schedule || options.reduction != defaults.reduction) {
+            throw std::runtime_error("ERROR: the sparse engine does not support other metrics, precisions, engines, schedules or reductions");
+        }
+        if (options.dedupe || options.order != INPUT_ORDER || options.pipeline || options.coresetSize > 0 || options.bisecting || options.multiresFraction > 0 || options.sweepMaxK > 0) {
+            throw std::runtime_error("ERROR: the sparse engine does not support the pre-passes, the coreset, the bisecting engine, the multi-resolution solve or the K sweep");
+        }
+        if (options.evaluate || options.profile || !options.trace.empty() || !options.checkpoint.empty() || options.resume || !options.initCentroids.empty()) {
+            throw std::runtime_error("ERROR: the sparse engine does not support the evaluation, the profiler, the tracer, the checkpoints or initial centroids");
+        }
+
+        return options;
+    }
+
+    SparsePoints SparseKMeans::initializeInputPoints() {
+        // Read the whole file.
+        std::ifstream file(filePath, std::ios::in | std::ios::binary);
+
+        if (!file.is_open()) {
+            throw std::runtime_error("ERROR: couldn't open file");
+        }
+
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        const std::string content = buffer.str();
+
+        // Find the beginning of the lines (skipping the empty and comment lines).
+        std::vector<size_t> lines;
+        for(size_t begin = 0; begin < content.size(); ) {
+            size_t end = content.find('\n', begin);
+            if (end == std::string::npos) {
+                end = content.size();
+            }
+
+            size_t first = content.find_first_not_of(" \t\r", begin);
+            if (first < end && content[first] != '#') {
+                lines.push_back(begin);
+            }
+
+            begin = end + 1;
+        }
+
+        N = lines.size();
+        if (N == 0) {
+            throw std::runtime_error("ERROR: no points in file");
+        }
+
+        // First pass: count the non-zero coordinates of each line and find the range of the indices.
+        long long* offsets = new long long[N + 1];
+        offsets[0] = 0;
+        int minIndex = INT_MAX, maxIndex = -1;
+
+        #pragma omp parallel for schedule(dynamic, SPARSE_CHUNK) num_threads(threads) reduction(min:minIndex) reduction(max:maxIndex)
+        for(long long i = 0; i < N; i++) {
+            const char* cursor = content.c_str() + lines[i];
+            long long count = 0;
+
+            while (*cursor != '\n' && *cursor != '\0' && *cursor != '#') {
+                if (*cursor == ':') {
+                    // The index precedes the colon.
+                    const char* start = cursor;
+                    while (start > content.c_str() + lines[i] && isdigit((unsigned char) start[-1])) {
+                        start--;
+                    }
+                    const int index = atoi(start);
+                    minIndex = std::min(minIndex, index);
+                    maxIndex = std::max(maxIndex, index);
+                    count++;
+                }
+                cursor++;
+            }
+
+            offsets[i + 1] = count;
+        }
+
+        // Prefix sum of the counts.
+        for(long long i = 0; i < N; i++) {
+            offsets[i + 1] += offsets[i];
+        }
+        const long long nonZeros = offsets[N];
+
+        // Indices are one-based unless an index 0 is found.
+        const int base = minIndex == 0 ? 0 : 1;
+        dimensions = std::max(1, maxIndex + 1 - base);
+
+        SparsePoints points(N, dimensions, nonZeros, offsets, new int[nonZeros], new double[nonZeros], new double[N], new long long[N], new int[N], new double[N]);
+
+        // Second pass: parse the lines.
+        #pragma omp parallel for schedule(dynamic, SPARSE_CHUNK) num_threads(threads)
+        for(long long i = 0; i < N; i++) {
+            const char* cursor = content.c_str() + lines[i];
+            char* next;
+
+            // The label (first token without a colon) is the weight of weighted points.
+            double weight = 1;
+            const char* token = cursor + strspn(cursor, " \t");
+            const size_t tokenLength = strcspn(token, " \t\r\n");
+            if (memchr(token, ':', tokenLength) == nullptr) {
+                const double label = strtod(token, &next);
+                if (options.weighted) {
+                    weight = label;
+                }
+                cursor = token + tokenLength;
+            }
+
+            double squaredNorm = 0;
+            for(long long p = offsets[i]; p < offsets[i + 1]; p++) {
+                // Parse the '<index>:<value>' pair.
+                const long index = strtol(cursor, &next, 10);
+                cursor = next + 1;
+                const double value = strtod(cursor, &next);
+                cursor = next;
+
+                points.indices[p] = (int) index - base;
+                points.values[p] = value;
+                squaredNorm += value * value;
+            }
+
+            points.squaredNorms[i] = squaredNorm;
+            points.pointsIds[i] = i;
+            points.clustersIds[i] = -1;
+            points.weights[i] = weight;
+        }
+
+        return points;
+    }
+
+    Centroids SparseKMeans::initializeCentroids() {
+        if (K > N) {
+            throw std::runtime_error("ERROR: K cannot be greater than N!");
+        }
+
+        // Uniform distribution between 0 and N-1 for selecting unique indices.
+        std::default_random_engine generator(SEED); // Random number engine (with seed for reproducibility).
+        std::uniform_int_distribution<long long> intDistribution(0, N - 1); // Uniform distribution.
+
+        // Set of random indices.
+        std::set<long long> randomIndices;
+
+        // Generate K random indices.
+        while ((int) randomIndices.size() < K) {
+            randomIndices.insert(intDistribution(generator));
+        }
+
+        // Initialize dense Centroids structure (zeroed in parallel for the first touch).
+        Centroids centroids(K, dimensions, new double[(size_t) K * dimensions], new int[K]);
+
+        #pragma omp parallel for schedule(static) num_threads(threads)
+        for(long long e = 0; e < (long long) K * dimensions; e++) {
+            centroids.coordinates[e] = 0;
+        }
+
+        // Scatter the K random points into the centroids.
+        int j = 0;
+        for(const long long i : randomIndices) {
+            for(long long p = points.offsets[i]; p < points.offsets[i + 1]; p++) {
+                centroids.coordinates[j + (size_t) K * points.indices[p]] = points.values[p];
+            }
+
+            centroids.clustersIds[j] = j;
+            j++;
+        }
+
+        return centroids;
+    }
+
+
+    bool SparseKMeans::KMeansIteration(long long& moved, double& inertia) {
+        const long long elements = (long long) K * dimensions; // Number of coordinates of the centroids.
+
+        if (clustersSum.size() != (size_t) elements) {
+            clustersSum.resize(elements);
+            clustersSize.resize(K);
+            centroidsNorms.resize(K);
+        }
+
+        // Convergence flag. Assume convergence at the beginning.
+        bool converged = true;
+        moved = 0;
+        inertia = 0;
+
+        double* sizes = clustersSize.data();
+        std::fill(sizes, sizes + K, 0.0);
+
+        #pragma omp parallel default(none) shared(elements, converged, moved, inertia, sizes)
+        {
+            // Reset the sums of the clusters.
+            #pragma omp for schedule(static)
+            for(long long e = 0; e < elements; e++) {
+                clustersSum[e] = 0;
+            }
+
+            // Squared norms of the centroids.
+            #pragma omp for schedule(static)
+            for(int j = 0; j < K; j++) {
+                double norm = 0;
+                for(int dim = 0; dim < dimensions; dim++) {
+                    norm += centroids.coordinates[j + (size_t) K * dim] * centroids.coordinates[j + (size_t) K * dim];
+                }
+                centroidsNorms[j] = norm;
+            }
+
+            // Dot products of the point with all the centroids (buffer of the thread).
+            std::vector<double> dots(K);
+
+            // Assign the points to the closest centroid and accumulate them (rows of varying lengths scheduled dynamically).
+            #pragma omp for schedule(dynamic, SPARSE_CHUNK) reduction(+:moved, inertia) reduction(+:sizes[:K])
+            for(long long i = 0; i < N; i++) {
+                std::fill(dots.begin(), dots.end(), 0.0);
+
+                // Sparse dot products (the centroids of a dimension are contiguous in the SoA layout).
+                for(long long p = points.offsets[i]; p < points.offsets[i + 1]; p++) {
+                    const double value = points.values[p];
+                    const double* column = &centroids.coordinates[(size_t) K * points.indices[p]];
+
+                    #pragma omp simd
+                    for(int j = 0; j < K; j++) {
+                        dots[j] += value * column[j];
+                    }
+                }
+
+                double minDist = DBL_MAX;
+                int minClusterId = -1;
+                for(int j = 0; j < K; j++) {
+                    const double dist = centroidsNorms[j] - 2 * dots[j];
+                    if (dist < minDist) {
+                        minDist = dist;
+                        minClusterId = j;
+                    }
+                }
+
+                // Count the points that changed cluster.
+                if (points.clustersIds[i] != minClusterId) {
+                    moved++;
+                }
+                points.clustersIds[i] = minClusterId;
+
+                // Accumulate the weighted squared distance (clamped against the cancellation).
+                const double weight = points.weights[i];
+                inertia += weight * std::max(0.0, points.squaredNorms[i] + minDist);
+
+                // Accumulate the non-zero coordinates of the point (sparse updates of the shared sums).
+                for(long long p = points.offsets[i]; p < points.offsets[i + 1]; p++) {
+                    #pragma omp atomic
+                    clustersSum[minClusterId + (size_t) K * points.indices[p]] += weight * points.values[p];
+                }
+                sizes[minClusterId] += weight;
+            }
+
+            // Update the centroids (the empty clusters keep their centroid) and check for convergence.
+            #pragma omp for schedule(static) reduction(&&:converged)
+            for(long long e = 0; e < elements; e++) {
+                const int j = e % K;
+                if (sizes[j] > 0) {
+                    const double coordinate = clustersSum[e] / sizes[j];
+                    if (fabs(coordinate - centroids.coordinates[e]) > EPSILON) {
+                        converged = false;
+                    }
+                    centroids.coordinates[e] = coordinate;
+                }
+            }
+        }
+
+        return converged;
+    }
+}
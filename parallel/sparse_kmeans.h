@@ -0,0 +1,90 @@
+#ifndef K_MEANS_PARALLEL_SPARSE_H
+#define K_MEANS_PARALLEL_SPARSE_H
+
+#include <string>
+#include <vector>
+
+#include "sparse_points.h"
+#include "centroids.h"
+#include "options.h"
+
+
+namespace Parallel {
+    // K-means on sparse points (CSR) with dense centroids.
+    class SparseKMeans {
+        public:
+            /*
+                * SparseKMeans constructor with points from a sparse dataset file (libsvm/svmlight format).
+                *
+                * @param filePath: Path of the file with the points.
+                * @param K: Number of clusters.
+                * @param threads: Number of threads.
+                * @param options: Optional settings of the execution.
+            */
+            SparseKMeans(const std::string& filePath, const int K, const int threads, const Options& options = Options());
+
+
+            /*
+                * Execution of the k-means algorithm.
+                *
+                * @param base_path: The base path for the results (default: 'results\\').
+                * @param log: True if the results should be logged, false otherwise (default: false).
+            */
+            void run(const std::string &base_path = "results\\", const bool log = false);
+
+        private:
+            const std::string filePath; // Path of the file with the points.
+            long long N; // Number of points.
+            const int K; // Number of clusters.
+            int dimensions; // Number of dimensions.
+            const int threads; // Number of threads.
+            const Options options; // Optional settings of the execution.
+
+            SparsePoints points; // Sparse points.
+            Centroids centroids; // Dense centroids.
+
+            std::vector<double> centroidsNorms; // Squared norms of the centroids.
+            std::vector<double> clustersSum; // Sums of coordinates of points in each cluster (same layout as the centroids).
+            std::vector<double> clustersSize; // Weighted number of points in each cluster.
+
+
+            /*
+                * Checks that the options are supported by the sparse engine (only the weights and the output), before the points are loaded.
+                *
+                * @param options: Optional settings of the execution.
+                *
+                * @returns (const Options&) The options.
+            */
+            static const Options& checkOptions(const Options& options);
+
+            /*
+                * Initializes the sparse points from the file (parsed in parallel over the lines).
+                * Each line is '<label> <index>:<value> ...' with one-based indices (zero-based if an index 0 is found);
+                * the label is the weight of the point with weighted points, and is ignored otherwise.
+                *
+                * @returns (SparsePoints) The sparse points.
+            */
+            SparsePoints initializeInputPoints();
+
+            /*
+                * Initializes the dense centroids with random points.
+                *
+                * @returns (Centroids) The centroids.
+            */
+            Centroids initializeCentroids();
+
+
+            /*
+                * Executes an iteration of the k-means algorithm.
+                * The distances are ||x||^2 - 2 x.c + ||c||^2, with the sparse dot products of a point with all the centroids at once.
+                *
+                * @param moved: Number of points that changed cluster.
+                * @param inertia: Weighted sum of the squared distances of the points to their centroid.
+                *
+                * @returns (bool) True if the centroids have converged.
+            */
+            bool KMeansIteration(long long& moved, double& inertia);
+    };
+}
+
+#endif // K_MEANS_PARALLEL_SPARSE_H
@@ -0,0 +1,26 @@
+#include "sparse_points.h"
+
+
+namespace Parallel {
+    SparsePoints::SparsePoints(const long long n, const int d, const long long nnz, long long* o, int* idx, double* v, double* norms, long long* pIds, int* cIds, double* w) : size(n), dimensions(d), nonZeros(nnz), offsets(o), indices(idx), values(v), squaredNorms(norms), pointsIds(pIds), clustersIds(cIds), weights(w) { }
+
+    SparsePoints::SparsePoints(SparsePoints&& other) : size(other.size), dimensions(other.dimensions), nonZeros(other.nonZeros), offsets(other.offsets), indices(other.indices), values(other.values), squaredNorms(other.squaredNorms), pointsIds(other.pointsIds), clustersIds(other.clustersIds), weights(other.weights) {
+        other.offsets = nullptr;
+        other.indices = nullptr;
+        other.values = nullptr;
+        other.squaredNorms = nullptr;
+        other.pointsIds = nullptr;
+        other.clustersIds = nullptr;
+        other.weights = nullptr;
+    }
+
+    SparsePoints::~SparsePoints() {
+        delete[] offsets;
+        delete[] indices;
+        delete[] values;
+        delete[] squaredNorms;
+        delete[] pointsIds;
+        delete[] clustersIds;
+        delete[] weights;
+    }
+}
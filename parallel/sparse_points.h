@@ -0,0 +1,56 @@
+#ifndef K_MEANS_PARALLEL_SPARSE_POINTS_H
+#define K_MEANS_PARALLEL_SPARSE_POINTS_H
+
+
+namespace Parallel {
+  // Sparse points in multidimensional space using CSR architecture.
+  struct SparsePoints {
+    const long long size; // Number of points.
+    const int dimensions; // Number of dimensions.
+    const long long nonZeros; // Number of non-zero coordinates.
+
+    long long* offsets; // Array of offsets of the non-zero coordinates of each point (size + 1).
+    int* indices; // Array of dimensions of the non-zero coordinates.
+    double* values; // Array of values of the non-zero coordinates.
+    double* squaredNorms; // Array of squared norms of the points.
+    long long* pointsIds; // Array of points identifiers.
+    int* clustersIds; // Array of clusters identifiers to which the points belong.
+    double* weights; // Array of points weights.
+
+
+    /*
+      * SparsePoints constructor.
+      *
+      * @param size: Number of points.
+      * @param dimensions: Number of dimensions.
+      * @param nonZeros: Number of non-zero coordinates.
+      * @param offsets: Array of offsets of the non-zero coordinates of each point.
+      * @param indices: Array of dimensions of the non-zero coordinates.
+      * @param values: Array of values of the non-zero coordinates.
+      * @param squaredNorms: Array of squared norms of the points.
+      * @param pointsIds: Array of points identifiers.
+      * @param clustersIds: Array of clusters identifiers to which the points belong.
+      * @param weights: Array of points weights.
+    */
+    SparsePoints(const long long size, const int dimensions, const long long nonZeros, long long* offsets, int* indices, double* values, double* squaredNorms, long long* pointsIds, int* clustersIds, double* weights);
+
+    /*
+      * SparsePoints move constructor.
+      *
+      * @param other: SparsePoints whose arrays are moved.
+    */
+    SparsePoints(SparsePoints&& other);
+
+    /*
+      * SparsePoints copy constructor (deleted since the arrays are owned).
+    */
+    SparsePoints(const SparsePoints& other) = delete;
+
+    /*
+      * SparsePoints destructor.
+    */
+    ~SparsePoints();
+  };
+}
+
+#endif // K_MEANS_PARALLEL_SPARSE_POINTS_H
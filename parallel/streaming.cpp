@@ -0,0 +1,353 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <cerrno>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <float.h>
+#include <omp.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "streaming.h"
+#include "loader.h"
+#include "writer.h"
+
+
+namespace Parallel {
+    StreamingKMeans::StreamingKMeans(const std::string& streamPath, const int K, const int dimensions, const int threads, const Options& options) : streamPath(streamPath), K(K), dimensions(dimensions), threads(threads), options(options), columns(options.weighted ? dimensions + 1 : dimensions), coordinates(new std::atomic<double>[K * dimensions]), states(new CentroidState[K]), stats(new WorkerStats[threads]) {
+        if (options.metric != EUCLIDEAN) {
+            throw std::runtime_error("ERROR: the streaming mode only supports the Euclidean metric");
+        }
+        if (options.streamDecay <= 0 || options.streamDecay > 1) {
+            throw std::runtime_error("ERROR: the decay of the streaming mode must be in (0, 1]");
+        }
+
+        for(long long c = 0; c < (long long) K * dimensions; c++) {
+            coordinates[c].store(0, std::memory_order_relaxed);
+        }
+    }
+
+
+    void StreamingKMeans::run() {
+        // Open the stream (a named pipe blocks until a writer opens it).
+        const int stream = streamPath == "-" ? STDIN_FILENO : open(streamPath.c_str(), O_RDONLY);
+        if (stream < 0) {
+            throw std::runtime_error("ERROR: couldn't open stream " + streamPath);
+        }
+
+        std::cout << "Streaming parallel k-means from " << (streamPath == "-" ? "stdin" : streamPath) << " with " << K << " clusters using #" << threads << " worker threads." << std::endl;
+
+        startTime = lastSnapshotTime = omp_get_wtime();
+
+        // The reader (this thread) feeds the worker threads (plain threads, so that each role has its thread whatever the limits of the OpenMP teams).
+        std::vector<std::thread> workers;
+        for(int worker = 0; worker < threads; worker++) {
+            workers.emplace_back(&StreamingKMeans::work, this, worker);
+        }
+        read(stream);
+        for(std::thread& worker : workers) {
+            worker.join();
+        }
+
+        if (stream != STDIN_FILENO) {
+            close(stream);
+        }
+
+        if (failed) {
+            throw std::runtime_error(error);
+        }
+        if (seeded < K) {
+            throw std::runtime_error("ERROR: the stream ended before " + std::to_string(K) + " points");
+        }
+
+        // Publish the final centroids.
+        publish(true);
+
+        if (failed) {
+            throw std::runtime_error(error);
+        }
+    }
+
+    Centroids StreamingKMeans::snapshot() const {
+        Centroids centroids(K, dimensions, new double[K * dimensions], new int[K]);
+
+        for(int j = 0; j < K; j++) {
+            // Copy a consistent version of the centroid (retrying if it was updated meanwhile).
+            uint64_t before, after;
+            do {
+                before = states[j].sequence.load(std::memory_order_acquire);
+                for(int dim = 0; dim < dimensions; dim++) {
+                    centroids.coordinates[j + K * dim] = coordinates[j * dimensions + dim].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                after = states[j].sequence.load(std::memory_order_relaxed);
+            } while ((before & 1) || before != after);
+
+            centroids.clustersIds[j] = j;
+        }
+
+        return centroids;
+    }
+
+
+    void StreamingKMeans::read(const int stream) {
+        std::vector<char> buffer(STREAM_CHUNK);
+        std::string carry; // Partial last line of the previous read.
+        double nextSnapshot = startTime + options.snapshotInterval;
+        bool end = false;
+
+        while (!end && !failed) {
+            const double now = omp_get_wtime();
+            if (now >= nextSnapshot) {
+                publish(false);
+                while (nextSnapshot <= omp_get_wtime()) nextSnapshot += options.snapshotInterval;
+                continue;
+            }
+
+            // Wait for data until the next snapshot.
+            pollfd descriptor = {stream, POLLIN, 0};
+            const int ready = poll(&descriptor, 1, (int) std::ceil((nextSnapshot - now) * 1000));
+            if (ready == 0 || (ready < 0 && errno == EINTR)) {
+                continue;
+            }
+
+            const ssize_t bytes = ready > 0 ? ::read(stream, buffer.data(), buffer.size()) : -1;
+            if (bytes < 0 && errno == EINTR) {
+                continue;
+            }
+            if (bytes < 0) {
+                std::lock_guard<std::mutex> lock(batchesMutex);
+                if (!failed.exchange(true)) {
+                    error = "ERROR: couldn't read stream " + streamPath;
+                }
+                break;
+            }
+
+            Batch batch;
+            batch.arrival = omp_get_wtime();
+            batch.columns = columns;
+            batch.text.swap(carry);
+            batch.text.append(buffer.data(), bytes);
+            end = bytes == 0;
+
+            // Carry the partial last line over to the next read.
+            if (!end) {
+                const size_t lineEnd = batch.text.rfind('\n');
+                if (lineEnd == std::string::npos) {
+                    carry.swap(batch.text);
+                    continue;
+                }
+                carry.assign(batch.text, lineEnd + 1, std::string::npos);
+                batch.text.resize(lineEnd + 1);
+            }
+
+            if (seeded < K) {
+                // Parse the first lines in the reader to initialize the centroids before any update (skipping the invalid lines).
+                parseRows(batch.text, batch.values, batch.rows, batch.columns, &seedingSkipped);
+                batch.text.clear();
+                initialize(batch);
+            }
+
+            if (batch.rows > 0 || !batch.text.empty()) {
+                enqueue(std::move(batch), nextSnapshot);
+            }
+        }
+
+        // Let the workers drain the queue and stop.
+        {
+            std::lock_guard<std::mutex> lock(batchesMutex);
+            finished = true;
+        }
+        batchesCondition.notify_all();
+    }
+
+    void StreamingKMeans::work(const int worker) {
+        WorkerStats& stat = stats[worker];
+
+        while (true) {
+            Batch batch;
+            {
+                std::unique_lock<std::mutex> lock(batchesMutex);
+                batchesCondition.wait(lock, [this] { return !batches.empty() || finished; });
+                if (batches.empty()) {
+                    return;
+                }
+
+                batch = std::move(batches.front());
+                batches.pop_front();
+            }
+            spaceCondition.notify_one();
+
+            if (!batch.text.empty()) {
+                // Parse the lines (skipping and counting the invalid ones, which don't stop the stream).
+                long long skipped = 0;
+                parseRows(batch.text, batch.values, batch.rows, batch.columns, &skipped);
+                if (skipped > 0) {
+                    stat.skipped.store(stat.skipped.load(std::memory_order_relaxed) + skipped, std::memory_order_relaxed);
+                }
+            }
+
+            // Assign each point and move its closest centroid.
+            for(long long r = 0; r < batch.rows; r++) {
+                const double* point = batch.values.data() + r * columns;
+                const double weight = options.weighted ? point[dimensions] : 1;
+
+                if (weight > 0) {
+                    update(closest(point), point, weight);
+                }
+            }
+
+            // Latency from the arrival of the batch to the update of its last point.
+            const double latency = omp_get_wtime() - batch.arrival;
+            stat.points.store(stat.points.load(std::memory_order_relaxed) + batch.rows, std::memory_order_relaxed);
+            stat.latency.store(stat.latency.load(std::memory_order_relaxed) + latency * batch.rows, std::memory_order_relaxed);
+            if (latency > stat.maxLatency.load(std::memory_order_relaxed)) {
+                stat.maxLatency.store(latency, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    int StreamingKMeans::closest(const double* point) const {
+        int closestId = 0;
+        double minDistance = DBL_MAX;
+
+        for(int j = 0; j < K; j++) {
+            const std::atomic<double>* centroid = coordinates.get() + j * dimensions;
+            double distance;
+
+            // Read a consistent version of the centroid (retrying if it was updated meanwhile).
+            uint64_t before, after;
+            do {
+                before = states[j].sequence.load(std::memory_order_acquire);
+                distance = 0;
+                for(int dim = 0; dim < dimensions; dim++) {
+                    const double difference = point[dim] - centroid[dim].load(std::memory_order_relaxed);
+                    distance += difference * difference;
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                after = states[j].sequence.load(std::memory_order_relaxed);
+            } while ((before & 1) || before != after);
+
+            if (distance < minDistance) {
+                minDistance = distance;
+                closestId = j;
+            }
+        }
+
+        return closestId;
+    }
+
+    void StreamingKMeans::update(const int j, const double* point, const double weight) {
+        CentroidState& state = states[j];
+        std::atomic<double>* centroid = coordinates.get() + j * dimensions;
+
+        // Lock the centroid (the sequence becomes odd).
+        uint64_t sequence = state.sequence.load(std::memory_order_relaxed);
+        while ((sequence & 1) || !state.sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            sequence = state.sequence.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        // Sequential update with the decayed weight of the centroid.
+        state.weight = options.streamDecay * state.weight + weight;
+        const double rate = weight / state.weight;
+        for(int dim = 0; dim < dimensions; dim++) {
+            const double coordinate = centroid[dim].load(std::memory_order_relaxed);
+            centroid[dim].store(coordinate + rate * (point[dim] - coordinate), std::memory_order_relaxed);
+        }
+
+        // Unlock the centroid (the sequence becomes even).
+        state.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    void StreamingKMeans::initialize(Batch& batch) {
+        long long used = 0;
+
+        for(; used < batch.rows && seeded < K; used++) {
+            const double* point = batch.values.data() + used * columns;
+            const double weight = options.weighted ? point[dimensions] : 1;
+            if (weight <= 0) continue;
+
+            for(int dim = 0; dim < dimensions; dim++) {
+                coordinates[seeded * dimensions + dim].store(point[dim], std::memory_order_relaxed);
+            }
+            states[seeded].weight = weight;
+            seeded++;
+        }
+
+        // Remove the rows of the initial centroids.
+        batch.values.erase(batch.values.begin(), batch.values.begin() + used * columns);
+        batch.rows -= used;
+    }
+
+    void StreamingKMeans::enqueue(Batch&& batch, double& nextSnapshot) {
+        std::unique_lock<std::mutex> lock(batchesMutex);
+
+        while (batches.size() >= (size_t) STREAM_QUEUE * threads && !failed) {
+            // Wait for space in the queue until the next snapshot.
+            spaceCondition.wait_for(lock, std::chrono::duration<double>(std::max(0.0, nextSnapshot - omp_get_wtime())));
+
+            if (omp_get_wtime() >= nextSnapshot) {
+                lock.unlock();
+                publish(false);
+                while (nextSnapshot <= omp_get_wtime()) nextSnapshot += options.snapshotInterval;
+                lock.lock();
+            }
+        }
+
+        batches.push_back(std::move(batch));
+        lock.unlock();
+        batchesCondition.notify_one();
+    }
+
+    void StreamingKMeans::publish(const bool final) {
+        const double now = omp_get_wtime();
+
+        // Statistics of the workers.
+        long long points = 0, skipped = seedingSkipped;
+        double latency = 0, maxLatency = 0;
+        for(int worker = 0; worker < threads; worker++) {
+            points += stats[worker].points.load(std::memory_order_relaxed);
+            skipped += stats[worker].skipped.load(std::memory_order_relaxed);
+            latency += stats[worker].latency.load(std::memory_order_relaxed);
+            maxLatency = std::max(maxLatency, stats[worker].maxLatency.load(std::memory_order_relaxed));
+        }
+
+        if (!options.output.empty() && seeded == K) {
+            // Write the snapshot to a temporary file renamed over the previous one, so that a reader never sees a partial snapshot.
+            const std::string filePath = options.output + ".centroids." + (options.outputFormat == BINARY_OUTPUT ? "bin" : "csv");
+
+            try {
+                writeCentroids(filePath + ".tmp", snapshot(), options.outputFormat, 1);
+                if (rename((filePath + ".tmp").c_str(), filePath.c_str()) != 0) {
+                    throw std::runtime_error("ERROR: couldn't write file " + filePath);
+                }
+            } catch (const std::runtime_error& exception) {
+                std::lock_guard<std::mutex> lock(batchesMutex);
+                if (!failed.exchange(true)) {
+                    error = exception.what();
+                }
+                return;
+            }
+        }
+        snapshots++;
+
+        if (final) {
+            std::cout << "Streamed " << points + seeded << " points in " << now - startTime << " seconds (" << (points + seeded) / (now - startTime) << " points/s), update latency " << (points > 0 ? 1000 * latency / points : 0) << " ms on average and " << 1000 * maxLatency << " ms at most, " << skipped << " invalid lines skipped, " << snapshots << " snapshots." << std::endl;
+        } else {
+            const long long intervalPoints = points - lastSnapshotPoints;
+            std::cout << "Snapshot " << snapshots << ": " << points + seeded << " points, " << intervalPoints / (now - lastSnapshotTime) << " points/s and update latency " << (intervalPoints > 0 ? 1000 * (latency - lastSnapshotLatency) / intervalPoints : 0) << " ms on average since the last snapshot, " << skipped << " invalid lines skipped." << std::endl;
+        }
+
+        lastSnapshotTime = now;
+        lastSnapshotPoints = points;
+        lastSnapshotLatency = latency;
+    }
+}
@@ -0,0 +1,157 @@
+#ifndef K_MEANS_PARALLEL_STREAMING_H
+#define K_MEANS_PARALLEL_STREAMING_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+
+#include "centroids.h"
+#include "options.h"
+#include "../params.h"
+
+
+namespace Parallel {
+  // Online k-means over an unbounded stream of points (one point per line, comma-separated coordinates) read from stdin or a named pipe.
+  // A reader thread cuts the stream into batches of whole lines, which the worker threads parse, assign and fold into the centroids
+  // with sequential (MacQueen) updates: the closest centroid moves towards the point by the weight of the point over the (decayed) weight of the centroid.
+  // Each centroid is guarded by its own sequence lock, so that the assignments read the centroids without locking and the updates of different centroids never contend.
+  class StreamingKMeans {
+    public:
+      /*
+        * StreamingKMeans constructor.
+        *
+        * @param streamPath: Path of the stream ('-' for stdin).
+        * @param K: Number of clusters (initialized with the first K points of the stream).
+        * @param dimensions: Number of dimensions.
+        * @param threads: Number of worker threads (the reader has its own thread).
+        * @param options: Optional settings of the execution (weighted points, decay, snapshot interval and output).
+      */
+      StreamingKMeans(const std::string& streamPath, const int K, const int dimensions, const int threads, const Options& options = Options());
+
+
+      /*
+        * Clusters the stream until its end, publishing a snapshot of the centroids at every interval and at the end.
+      */
+      void run();
+
+      /*
+        * Takes a snapshot of the centroids (each centroid is copied from a consistent version, without stopping the updates).
+        *
+        * @returns (Centroids) The snapshot of the centroids.
+      */
+      Centroids snapshot() const;
+
+    private:
+      // Lines of the stream processed by a worker.
+      struct Batch {
+        std::string text; // Text of the lines (empty if already parsed).
+        std::vector<double> values; // Values of the parsed rows (row-major).
+        long long rows = 0; // Number of parsed rows.
+        int columns = 0; // Number of columns of the parsed rows (the expected number, set before the parsing).
+        double arrival = 0; // Wall time at which the lines were read.
+      };
+
+      // Sequence lock and decayed weight of a centroid (aligned to avoid false sharing).
+      struct alignas(CACHE_LINE_SIZE) CentroidState {
+        std::atomic<uint64_t> sequence{0}; // Odd while the centroid is updated.
+        double weight = 0; // Decayed weight of the points of the centroid (written under the lock).
+      };
+
+      // Statistics of a worker (aligned to avoid false sharing, written by the worker only).
+      struct alignas(CACHE_LINE_SIZE) WorkerStats {
+        std::atomic<long long> points{0}; // Number of processed points.
+        std::atomic<double> latency{0}; // Sum over the points of the time from their arrival to their update.
+        std::atomic<double> maxLatency{0}; // Maximum time from the arrival of a batch to the update of its last point.
+        std::atomic<long long> skipped{0}; // Number of skipped invalid lines.
+      };
+
+      const std::string streamPath; // Path of the stream.
+      const int K; // Number of clusters.
+      const int dimensions; // Number of dimensions.
+      const int threads; // Number of worker threads.
+      const Options options; // Optional settings of the execution.
+      const int columns; // Number of columns of a line (the last one is the weight of weighted points).
+
+      std::unique_ptr<std::atomic<double>[]> coordinates; // Coordinates of the centroids (row-major, so that a centroid is updated in one place).
+      std::unique_ptr<CentroidState[]> states; // Sequence locks and weights of the centroids.
+      std::unique_ptr<WorkerStats[]> stats; // Statistics of the workers.
+
+      std::deque<Batch> batches; // Batches waiting for a worker.
+      std::mutex batchesMutex; // Lock of the batches.
+      std::condition_variable batchesCondition; // Signaled when a batch is queued or the stream ends.
+      std::condition_variable spaceCondition; // Signaled when a batch is taken (the reader waits for space in the queue).
+      bool finished = false; // True when the stream has ended (or failed).
+      std::atomic<bool> failed{false}; // True if the reading of the stream or the writing of a snapshot failed.
+      std::string error; // Message of the failure.
+
+      int seeded = 0; // Number of initialized centroids (the first points of the stream).
+      long long seedingSkipped = 0; // Number of invalid lines skipped by the reader before the initialization of the centroids.
+      double startTime = 0; // Wall time at the beginning of the stream.
+      double lastSnapshotTime = 0; // Wall time of the last snapshot.
+      long long lastSnapshotPoints = 0; // Number of points processed at the last snapshot.
+      double lastSnapshotLatency = 0; // Sum of the update latencies of the points at the last snapshot.
+      int snapshots = 0; // Number of published snapshots.
+
+
+      /*
+        * Reads the stream into batches, initializes the centroids and publishes the snapshots (loop of the reader thread).
+        *
+        * @param stream: Descriptor of the stream.
+      */
+      void read(const int stream);
+
+      /*
+        * Parses, assigns and folds the queued batches into the centroids (loop of a worker thread).
+        *
+        * @param worker: Index of the worker.
+      */
+      void work(const int worker);
+
+      /*
+        * Finds the closest centroid of a point (reading each centroid without locking, retrying if it was updated meanwhile).
+        *
+        * @param point: Coordinates of the point.
+        *
+        * @returns (int) The identifier of the closest centroid.
+      */
+      int closest(const double* point) const;
+
+      /*
+        * Moves a centroid towards a point (under the sequence lock of the centroid).
+        *
+        * @param j: The identifier of the centroid.
+        * @param point: Coordinates of the point.
+        * @param weight: Weight of the point.
+      */
+      void update(const int j, const double* point, const double weight);
+
+      /*
+        * Initializes the centroids with the first rows of a parsed batch (removing them from the batch).
+        *
+        * @param batch: The parsed batch.
+      */
+      void initialize(Batch& batch);
+
+      /*
+        * Queues a batch for the workers (waiting for space in the queue, and publishing the snapshots that are due meanwhile).
+        *
+        * @param batch: The batch.
+        * @param nextSnapshot: Wall time of the next snapshot (advanced by the function).
+      */
+      void enqueue(Batch&& batch, double& nextSnapshot);
+
+      /*
+        * Publishes a snapshot of the centroids (to the output file if any) and reports the throughput and the update latency.
+        *
+        * @param final: True if it is the last snapshot.
+      */
+      void publish(const bool final);
+  };
+}
+
+#endif // K_MEANS_PARALLEL_STREAMING_H
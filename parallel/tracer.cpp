@@ -0,0 +1,113 @@
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <omp.h>
+
+#include "tracer.h"
+#include "../params.h"
+
+
+namespace Parallel {
+    Tracer::Tracer(const std::string& p, const int t, const double o) : enabled(!p.empty()), path(p), origin(o), threadsEvents(enabled ? t : 0) {
+        if (enabled) {
+            // Open the metrics log.
+            metrics.open(path + ".jsonl");
+
+            if (!metrics.is_open()) {
+                throw std::runtime_error("ERROR: couldn't open trace file");
+            }
+            metrics << std::setprecision(10);
+
+            // Reserve the spans of the phases of all the iterations to avoid reallocations while tracing.
+            for (ThreadEvents& threadEvents : threadsEvents) {
+                threadEvents.events.reserve(NUM_PHASES * MAX_ITERATIONS);
+            }
+        }
+    }
+
+
+    void Tracer::span(const Phase phase, const int thread, const double start, const double end) {
+        ThreadEvents& threadEvents = threadsEvents[thread];
+        threadEvents.events.push_back({PHASE_NAMES[phase], start, end});
+
+        if (phase == ASSIGNMENT) {
+            threadEvents.assignmentTime += end - start;
+        }
+    }
+
+    void Tracer::stage(const std::string& name, const double start, const double end) {
+        if (!enabled) {
+            return;
+        }
+
+        stages.push_back({name, start, end});
+
+        metrics << "{\"stage\":\"" << name << "\",\"start\":" << start - origin << ",\"duration\":" << end - start << "}\n";
+    }
+
+    void Tracer::iteration(IterationMetrics& iterationMetrics, const double start) {
+        if (!enabled) {
+            return;
+        }
+
+        stages.push_back({"iteration " + std::to_string(iterationMetrics.iteration + 1), start, start + iterationMetrics.time});
+
+        // Compute the imbalance of the assignment phase and reset the threads times.
+        double maxTime = 0, sumTime = 0;
+        int activeThreads = 0;
+        for (ThreadEvents& threadEvents : threadsEvents) {
+            if (threadEvents.assignmentTime > 0) {
+                maxTime = std::max(maxTime, threadEvents.assignmentTime);
+                sumTime += threadEvents.assignmentTime;
+                activeThreads++;
+            }
+            threadEvents.assignmentTime = 0;
+        }
+        iterationMetrics.imbalance = sumTime > 0 ? maxTime / (sumTime / activeThreads) : 1;
+
+        metrics << "{\"stage\":\"iteration\",\"iteration\":" << iterationMetrics.iteration
+                << ",\"start\":" << start - origin
+                << ",\"time\":" << iterationMetrics.time
+                << ",\"moved\":" << iterationMetrics.moved
+                << ",\"inertia\":" << iterationMetrics.inertia
+                << ",\"max_shift\":" << iterationMetrics.maxShift
+                << ",\"imbalance\":" << iterationMetrics.imbalance;
+        if (iterationMetrics.recall >= 0) {
+            metrics << ",\"recall\":" << iterationMetrics.recall;
+        }
+        metrics << "}\n";
+    }
+
+
+    void Tracer::write() {
+        if (!enabled) {
+            return;
+        }
+
+        metrics.flush();
+
+        std::ofstream trace(path + ".trace.json");
+        if (!trace.is_open()) {
+            throw std::runtime_error("ERROR: couldn't open trace file");
+        }
+        trace << std::fixed << std::setprecision(3);
+
+        // Complete events with microseconds timestamps.
+        trace << "{\"traceEvents\":[\n";
+        trace << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"k-means\"}}";
+        for (size_t i = 0; i < stages.size(); i++) {
+            trace << ",\n{\"name\":\"" << stages[i].name << "\",\"cat\":\"stage\",\"ph\":\"X\",\"pid\":1,\"tid\":0"
+                  << ",\"ts\":" << (stages[i].start - origin) * 1e6 << ",\"dur\":" << (stages[i].end - stages[i].start) * 1e6 << "}";
+        }
+        for (size_t t = 0; t < threadsEvents.size(); t++) {
+            for (const Event& event : threadsEvents[t].events) {
+                trace << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":1,\"tid\":" << t + 1
+                      << ",\"ts\":" << (event.start - origin) * 1e6 << ",\"dur\":" << (event.end - event.start) * 1e6 << "}";
+            }
+        }
+        trace << "\n]}\n";
+        trace.close();
+
+        std::cout << "Trace written to " << path << ".jsonl and " << path << ".trace.json." << std::endl;
+    }
+}
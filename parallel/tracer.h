@@ -0,0 +1,104 @@
+#ifndef K_MEANS_PARALLEL_TRACER_H
+#define K_MEANS_PARALLEL_TRACER_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "phases.h"
+
+
+namespace Parallel {
+  // Metrics of a k-means iteration.
+  struct IterationMetrics {
+    int iteration = 0; // Index of the iteration.
+    double time = 0; // Wall time of the iteration.
+    long long moved = 0; // Number of points that changed cluster.
+    double inertia = 0; // Sum of the squared distances of the points to their centroid.
+    double maxShift = 0; // Maximum displacement of a centroid.
+    double imbalance = 1; // Ratio between the maximum and the mean assignment time of the threads.
+    double recall = -1; // Fraction of the audited points assigned to their exact closest centroid (-1 if not audited).
+  };
+
+
+  // Tracer of the execution, buffered in memory and exported in JSON-lines and Chrome trace_event formats.
+  class Tracer {
+    public:
+      const bool enabled; // True if the tracer records the execution.
+
+
+      /*
+        * Tracer constructor.
+        *
+        * @param path: Prefix of the trace files (the tracer is disabled if empty).
+        * @param threads: Maximum number of threads.
+        * @param origin: Wall time of the origin of the timestamps (e.g. the beginning of the construction of the k-means).
+      */
+      Tracer(const std::string& path, const int threads, const double origin);
+
+
+      /*
+        * Records the span of a phase executed by a thread.
+        *
+        * @param phase: The phase.
+        * @param thread: The identifier of the thread.
+        * @param start: The wall time at the beginning of the span.
+        * @param end: The wall time at the end of the span.
+      */
+      void span(const Phase phase, const int thread, const double start, const double end);
+
+      /*
+        * Records a span of the main thread (e.g. loading or seeding) and streams it to the metrics log.
+        *
+        * @param name: The name of the span.
+        * @param start: The wall time at the beginning of the span.
+        * @param end: The wall time at the end of the span.
+      */
+      void stage(const std::string& name, const double start, const double end);
+
+      /*
+        * Records the span of an iteration and streams its metrics to the metrics log.
+        *
+        * @param metrics: The metrics of the iteration (the imbalance is filled by the tracer).
+        * @param start: The wall time at the beginning of the iteration.
+      */
+      void iteration(IterationMetrics& metrics, const double start);
+
+
+      /*
+        * Writes the Chrome trace_event file and flushes the metrics log.
+      */
+      void write();
+
+    private:
+      // Span of the trace.
+      struct Event {
+        const char* name; // Name of the span.
+        double start; // Wall time at the beginning of the span.
+        double end; // Wall time at the end of the span.
+      };
+
+      // Events of a thread (aligned to avoid false sharing).
+      struct alignas(64) ThreadEvents {
+        std::vector<Event> events; // Spans of the thread.
+        double assignmentTime = 0; // Assignment time of the current iteration.
+      };
+
+      // Span of the main thread.
+      struct Stage {
+        std::string name; // Name of the span.
+        double start; // Wall time at the beginning of the span.
+        double end; // Wall time at the end of the span.
+      };
+
+      const std::string path; // Prefix of the trace files.
+      const double origin; // Wall time of the origin of the timestamps.
+
+      std::vector<ThreadEvents> threadsEvents; // Spans of each thread.
+      std::vector<Stage> stages; // Spans of the main thread.
+
+      std::ofstream metrics; // Stream of the metrics log.
+  };
+}
+
+#endif // K_MEANS_PARALLEL_TRACER_H
@@ -0,0 +1,198 @@
+#include <string>
+#include <vector>
+#include <charconv>
+#include <algorithm>
+#include <stdexcept>
+#include <omp.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "writer.h"
+#include "../params.h"
+
+
+namespace Parallel {
+    /*
+        * Writes a buffer at an offset of a file (retrying the partial writes).
+        *
+        * @param file: Descriptor of the file.
+        * @param buffer: The buffer.
+        * @param size: Number of bytes of the buffer.
+        * @param offset: Offset of the buffer in the file.
+        *
+        * @returns (bool) True if the buffer was written.
+    */
+    static bool writeAt(const int file, const char* buffer, size_t size, off_t offset) {
+        while (size > 0) {
+            const ssize_t written = pwrite(file, buffer, size, offset);
+            if (written <= 0) {
+                return false;
+            }
+            buffer += written;
+            size -= written;
+            offset += written;
+        }
+
+        return true;
+    }
+
+    /*
+        * Opens a file for writing (truncated).
+        *
+        * @param filePath: Path of the file.
+        *
+        * @returns (int) Descriptor of the file.
+    */
+    static int openOutput(const std::string& filePath) {
+        const int file = open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (file < 0) {
+            throw std::runtime_error("ERROR: couldn't open file " + filePath);
+        }
+
+        return file;
+    }
+
+    /*
+        * Writes rows of text in parallel: in each round, every thread formats a chunk of rows into its buffer,
+        * then the offsets of the chunks are computed from their lengths and the chunks are written at their offsets.
+        *
+        * @param file: Descriptor of the file.
+        * @param rows: Number of rows.
+        * @param maxRowLength: Maximum number of characters of a row.
+        * @param format: Function formatting a row at a position of a buffer and returning the position after the row.
+        * @param threads: Number of threads.
+        *
+        * @returns (bool) True if all the rows were written.
+    */
+    template <typename Format>
+    static bool writeText(const int file, const long long rows, const size_t maxRowLength, const Format& format, const int threads) {
+        const long long chunkRows = std::max((size_t) 1, WRITE_BUFFER / maxRowLength); // Number of rows of a chunk.
+        const long long numChunks = (rows + chunkRows - 1) / chunkRows;
+
+        std::vector<size_t> lengths(threads, 0), offsets(threads, 0);
+        off_t base = 0;
+        bool failed = false;
+
+        #pragma omp parallel num_threads(threads)
+        {
+            const int thread = omp_get_thread_num();
+            const int numThreads = omp_get_num_threads();
+            std::vector<char> buffer(std::min(rows, chunkRows) * maxRowLength);
+
+            for(long long first = 0; first < numChunks; first += numThreads) {
+                // Format the chunk of the thread.
+                const long long chunk = first + thread;
+                char* end = buffer.data();
+                if (chunk < numChunks) {
+                    const long long last = std::min(rows, (chunk + 1) * chunkRows);
+                    for(long long row = chunk * chunkRows; row < last; row++) {
+                        end = format(row, end);
+                    }
+                }
+                lengths[thread] = end - buffer.data();
+
+                #pragma omp barrier
+
+                // Offsets of the chunks of the round.
+                #pragma omp single
+                {
+                    for(int t = 0; t < numThreads; t++) {
+                        offsets[t] = base;
+                        base += lengths[t];
+                    }
+                }
+
+                if (lengths[thread] > 0 && !writeAt(file, buffer.data(), lengths[thread], offsets[thread])) {
+                    #pragma omp atomic write
+                    failed = true;
+                }
+            }
+        }
+
+        return !failed;
+    }
+
+
+    void writeLabels(const std::string& filePath, const int* clustersIds, const long long* rowToPoint, const long long rows, const OutputFormat format, const int threads) {
+        const int file = openOutput(filePath);
+        bool written = true;
+
+        if (format == CSV_OUTPUT) {
+            // At most 11 characters of a label and the end of line.
+            written = writeText(file, rows, 12, [clustersIds, rowToPoint](const long long row, char* out) {
+                out = std::to_chars(out, out + 11, clustersIds[rowToPoint == nullptr ? row : rowToPoint[row]]).ptr;
+                *out++ = '\n';
+                return out;
+            }, threads);
+        } else {
+            const long long chunkRows = WRITE_BUFFER / sizeof(int); // Number of rows of a chunk.
+            const long long numChunks = (rows + chunkRows - 1) / chunkRows;
+
+            #pragma omp parallel num_threads(threads)
+            {
+                std::vector<int> buffer(rowToPoint == nullptr ? 0 : chunkRows);
+
+                #pragma omp for schedule(static)
+                for(long long chunk = 0; chunk < numChunks; chunk++) {
+                    const long long begin = chunk * chunkRows;
+                    const long long end = std::min(rows, begin + chunkRows);
+
+                    // Gather the labels of the original points (the chunk is written in place otherwise).
+                    const int* labels = clustersIds + begin;
+                    if (rowToPoint != nullptr) {
+                        for(long long row = begin; row < end; row++) {
+                            buffer[row - begin] = clustersIds[rowToPoint[row]];
+                        }
+                        labels = buffer.data();
+                    }
+
+                    if (!writeAt(file, (const char*) labels, (end - begin) * sizeof(int), begin * sizeof(int))) {
+                        #pragma omp atomic write
+                        written = false;
+                    }
+                }
+            }
+        }
+
+        close(file);
+
+        if (!written) {
+            throw std::runtime_error("ERROR: couldn't write file " + filePath);
+        }
+    }
+
+    void writeCentroids(const std::string& filePath, const Centroids& centroids, const OutputFormat format, const int threads) {
+        const int K = centroids.size, dimensions = centroids.dimensions;
+        const int file = openOutput(filePath);
+        bool written = true;
+
+        if (format == CSV_OUTPUT) {
+            // At most 24 characters of the shortest representation of a coordinate and a separator.
+            written = writeText(file, K, 25 * (size_t) dimensions, [&centroids, K, dimensions](const long long row, char* out) {
+                for(int dim = 0; dim < dimensions; dim++) {
+                    out = std::to_chars(out, out + 24, centroids.coordinates[row + (long long) K * dim]).ptr;
+                    *out++ = dim + 1 < dimensions ? ',' : '\n';
+                }
+                return out;
+            }, threads);
+        } else {
+            // Header and rows of the centroids.
+            const int header[2] = {K, dimensions};
+            std::vector<double> values((size_t) K * dimensions);
+            for(int j = 0; j < K; j++) {
+                for(int dim = 0; dim < dimensions; dim++) {
+                    values[(size_t) j * dimensions + dim] = centroids.coordinates[j + K * dim];
+                }
+            }
+
+            written = writeAt(file, (const char*) header, sizeof(header), 0) && writeAt(file, (const char*) values.data(), values.size() * sizeof(double), sizeof(header));
+        }
+
+        close(file);
+
+        if (!written) {
+            throw std::runtime_error("ERROR: couldn't write file " + filePath);
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef K_MEANS_PARALLEL_WRITER_H
+#define K_MEANS_PARALLEL_WRITER_H
+
+#include <string>
+
+#include "centroids.h"
+#include "options.h"
+
+
+namespace Parallel {
+  /*
+    * Writes the labels of the points (one per line with the CSV format, int32 with the binary format).
+    * The chunks of rows are formatted in parallel into per-thread buffers and written with positioned writes at their offsets.
+    *
+    * @param filePath: Path of the file.
+    * @param clustersIds: Array of clusters identifiers of the points.
+    * @param rowToPoint: Array mapping each original point to its point, or null if identity.
+    * @param rows: Number of original points.
+    * @param format: Format of the file.
+    * @param threads: Number of threads.
+  */
+  void writeLabels(const std::string& filePath, const int* clustersIds, const long long* rowToPoint, const long long rows, const OutputFormat format, const int threads);
+
+  /*
+    * Writes the centroids (one per line with comma-separated coordinates with the CSV format,
+    * the int32 number of centroids and dimensions followed by the float64 rows with the binary format).
+    *
+    * @param filePath: Path of the file.
+    * @param centroids: The centroids.
+    * @param format: Format of the file.
+    * @param threads: Number of threads.
+  */
+  void writeCentroids(const std::string& filePath, const Centroids& centroids, const OutputFormat format, const int threads);
+}
+
+#endif // K_MEANS_PARALLEL_WRITER_H
@@ -6,5 +6,47 @@
 #define MAX_ITERATIONS 500 // Maximum number of iterations.
 #define EPSILON 1e-6 // Precision for the convergence.
 #define ANIMATION_FACTOR 10 // Factor for the animation speed.
+#define PEAK_GFLOPS 100.0 // Peak floating point throughput of the machine (GFLOP/s) for the roofline bound.
+#define PEAK_BANDWIDTH 20.0 // Peak memory bandwidth of the machine (GB/s) for the roofline bound.
+#define CACHE_LINE_SIZE 64 // Size of a cache line in bytes.
+#define POINT_TILE 64 // Default number of points of a tile of the assignment kernels.
+#define MAX_POINT_TILE 256 // Maximum number of points of a tile of the quantized assignment kernel.
+#define CENTROID_TILE 16 // Default number of centroids of a tile of the tiled assignment kernel.
+#define MAX_CENTROID_TILE 32 // Maximum number of centroids of a tile of the tiled assignment kernel (tuned or cached).
+#define AUTOTUNE_SAMPLE 65536 // Number of points sampled for the probe iterations of the autotuner.
+#define AUTOTUNE_REPETITIONS 3 // Number of timed probe iterations for each candidate configuration.
+#define TUNING_CACHE "tuning.cache" // Default path of the tuning cache file.
+#define MIN_CHUNK 1 // Minimum number of blocks of a chunk of the work-stealing schedule.
+#define CHUNK_DIVISOR 8 // Fraction of the remaining blocks of a range taken as a chunk of the work-stealing schedule.
+#define REDUCTION_BLOCK_SIZE 4096 // Minimum number of points of a block of the deterministic reduction.
+#define MAX_REDUCTION_BLOCKS 1024 // Maximum number of blocks of the deterministic reduction.
+#define MAX_REDUCTION_MEMORY (256LL << 20) // Maximum memory (in bytes) of the partial sums of the deterministic reduction.
+#define IVF_NPROBE 8 // Default number of lists scanned by a query of the centroid index.
+#define AUDIT_SAMPLE 1024 // Number of points of the recall audit of the approximate assignment.
+#define SKETCH_DIMENSIONS 16 // Default number of dimensions of the random-projection sketch.
+#define MAX_SKETCH_DIMENSIONS 64 // Maximum number of dimensions of the random-projection sketch.
+#define SHORTLIST 4 // Default number of centroids shortlisted in the sketch for the exact re-ranking.
+#define PROJECTION_BLOCK 256 // Number of points of a block of the projection of the points.
+#define SPARSE_CHUNK 64 // Number of rows of a chunk of the dynamic schedule of the sparse points.
+#define BISECTING_GRAIN 16384 // Number of points of a task of the 2-means passes of the bisecting engine.
+#define BISECTING_SEED_ATTEMPTS 16 // Maximum number of draws for a second initial centroid distinct from the first one in a 2-means split.
+#define SAMPLE_BLOCK 65536 // Number of points of a block of the parallel uniform subsample (with its own generator).
+#define MULTIRES_FRACTION 0.01 // Default fraction of the points of the first subsample stage of the multi-resolution solve.
+#define MULTIRES_FACTOR 10 // Growth factor of the subsample between two stages of the multi-resolution solve.
+#define MULTIRES_CLUSTER_POINTS 32 // Minimum expected number of points per cluster of a subsample stage of the multi-resolution solve.
+#define SILHOUETTE_EXACT 20000 // Maximum number of points of the exact silhouette (estimated on a stratified sample above).
+#define SILHOUETTE_SAMPLE 4096 // Number of points of the stratified sample of the silhouette.
+#define EVALUATION_TILE 16 // Number of evaluated points of a tile of the silhouette (streamed against all the points).
+#define PREDICT_GRAIN 4096 // Minimum number of points of a batch assigned in parallel by a fitted model.
+#define DATASET_CACHE_MEMORY (4LL << 30) // Maximum memory (in bytes) of the datasets cached by the server.
+#define CHECKPOINT_INTERVAL 10 // Default number of iterations between two checkpoints.
+#define SERVER_BACKLOG 64 // Maximum number of pending connections of the server socket.
+#define SERVER_RECEIVE_TIMEOUT 5 // Maximum number of seconds the server waits for the arguments of a job from a client.
+#define WRITE_BUFFER (1 << 20) // Size (in bytes) of the buffer of a chunk of rows formatted by a thread of the parallel writer.
+#define LOAD_CHUNK (4 << 20) // Size (in bytes) of a chunk of lines read (and decompressed) by the loader and parsed by a task.
+#define STREAM_CHUNK (1 << 16) // Maximum size (in bytes) of a read of the stream of the streaming mode (a batch of lines for a worker).
+#define STREAM_QUEUE 4 // Maximum number of batches waiting for each worker of the streaming mode (the reader blocks beyond, throttling the stream).
+#define STREAM_DECAY 1.0 // Default decay of the weights of the centroids for each point of the streaming mode (1 for the plain sequential k-means).
+#define SNAPSHOT_INTERVAL 10.0 // Default number of seconds between two snapshots of the centroids of the streaming mode.
 
 #endif // PARAMS_H
@@ -12,9 +12,9 @@
 
 
 namespace Sequential {
-    KMeans::KMeans(const int n, const int k, const int d) : N(n), K(k), dimensions(d), points (initializeRandomPoints()), centroids(initializeCentroids()) { }
+    KMeans::KMeans(const long long n, const int k, const int d) : N(n), K(k), dimensions(d), points (initializeRandomPoints()), centroids(initializeCentroids()) { }
 
-    KMeans::KMeans(const std::string& filePath, const int k) : filePath(filePath), K(k), points(initializeInputPoints()), centroids(initializeCentroids()) { }
+    KMeans::KMeans(const std::string& filePath, const int k, const bool w) : filePath(filePath), weighted(w), K(k), points(initializeInputPoints()), centroids(initializeCentroids()) { }
 
 
     void KMeans::run(const std::string &basePath, const bool log) {
@@ -67,7 +67,7 @@ namespace Sequential {
             convert_gif(iterations, executionTimes, paths, "sequential");
         }
 
-        std::cout << "Converged after " << iterations << " iterations in " << executionTimes << " seconds." << std::endl;
+        std::cout << "Converged after " << iterations << " iterations in " << executionTimes << " seconds (inertia " << inertia << ")." << std::endl;
 
         // Save the results.
         save_results(iterations, executionTimes, paths, "sequential", N, K, dimensions);
@@ -83,7 +83,7 @@ namespace Sequential {
         std::vector<Point> points(N, Point(dimensions, std::vector<double>(dimensions, 0), 0, -1));
 
         // Generate N random points from the uniform distribution.
-        for(int i = 0; i < N; i++) {
+        for(long long i = 0; i < N; i++) {
             for(int dim = 0; dim < dimensions; dim++) {
                 // Generate a random coordinate.
                 points[i].coordinates[dim] = uniformDistribution(generator);
@@ -115,12 +115,12 @@ namespace Sequential {
         while (std::getline(ss, line, ',')) numColumns++;
 
         // Count the number of lines in the file.
-        int numLines = 1;
+        long long numLines = 1;
         while (std::getline(file, line)) numLines++;
 
-        // Set N and dimensions based on the file content.
+        // Set N and dimensions based on the file content (the last column is the weight of weighted points).
         N = numLines; // Number of points.
-        dimensions = numColumns; // Number of dimensions.
+        dimensions = weighted ? numColumns - 1 : numColumns; // Number of dimensions.
 
 
         // Reopen the file for reading from the beginning.
@@ -130,11 +130,17 @@ namespace Sequential {
         // Initialize vector of points.
         std::vector<Point> points(N, Point(dimensions, std::vector<double>(dimensions, 0), 0, -1));
 
-        int i = 0;
+        long long i = 0;
         while (getline(file, line)) {
             std::stringstream str(line);
             int dim = 0;
             while (getline(str, word, ',')) {
+                if (dim == dimensions) {
+                    // Set the weight of the point.
+                    points[i].weight = std::stod(word);
+                    break;
+                }
+
                 // Set the coordinate to the point.
                 points[i].coordinates[dim] = std::stod(word);
 
@@ -159,14 +165,14 @@ namespace Sequential {
 
         // Uniform distribution between 0 and N-1 for selecting unique indices.
         std::default_random_engine generator(SEED); // Random number engine (with seed for reproducibility).
-        std::uniform_int_distribution<int> intDistribution(0, N - 1); // Uniform distribution.
+        std::uniform_int_distribution<long long> intDistribution(0, N - 1); // Uniform distribution.
 
         // Vector of random indices.
-        std::set<int> randomIndices;
+        std::set<long long> randomIndices;
 
         // Generate K random indices.
         while (randomIndices.size() < K) {
-            int randomIndex = intDistribution(generator);
+            long long randomIndex = intDistribution(generator);
 
             // Check if the random index is unique.
             if (randomIndices.find(randomIndex) == randomIndices.end()) {
@@ -180,7 +186,7 @@ namespace Sequential {
         // Generate K random centroids from points.
         for(int j = 0; j < K; j++) {
             // Get the j-th random index.
-            int randomIndex = *std::next(randomIndices.begin(), j);
+            long long randomIndex = *std::next(randomIndices.begin(), j);
 
             for(int dim = 0; dim < dimensions; dim++) {
                 // Set the coordinates of the centroid.
@@ -208,13 +214,16 @@ namespace Sequential {
     bool KMeans::KMeansIteration() {
         // Variables for the mean of the points in each cluster.
         std::vector<std::vector<double>> clustersSum(K, std::vector<double>(dimensions, 0)); // Sum of coordinates of points in each cluster.
-        std::vector<int> clustersSize(K, 0); // Number of points in each cluster.
+        std::vector<double> clustersSize(K, 0); // Weighted number of points in each cluster.
 
         // Convergence flag. Assume convergence at the beginning.
         bool converged = true;
 
+        // Reset the inertia.
+        inertia = 0;
+
         // Assign each point to the closest centroid.
-        for(int i = 0; i < N; i++) {
+        for(long long i = 0; i < N; i++) {
             double minDist = DBL_MAX; // Distance to the closest cluster (initialized to infinity).
             int minClusterId = -1; // Id of the closest cluster (initialize to -1).
 
@@ -230,13 +239,16 @@ namespace Sequential {
             // Assign the point to the closest cluster.
             points[i].clusterId = minClusterId;
 
+            // Accumulate the weighted squared distance to the closest centroid.
+            inertia += points[i].weight * minDist * minDist;
+
             for(int dim = 0; dim < dimensions; dim++) {
-                // Sum the coordinates of the point assigned to the cluster.
-                clustersSum[minClusterId][dim] += points[i].coordinates[dim];
+                // Sum the weighted coordinates of the point assigned to the cluster.
+                clustersSum[minClusterId][dim] += points[i].weight * points[i].coordinates[dim];
             }
 
-            // Increment the size of the cluster.
-            clustersSize[minClusterId]++;
+            // Increment the weighted size of the cluster.
+            clustersSize[minClusterId] += points[i].weight;
         }
             
         // Update the centroids.
@@ -268,7 +280,7 @@ namespace Sequential {
         std::vector<std::vector<double>> coordinates(data.size(), std::vector<double>(dimensions, 0));
         
         // Fill the coordinates vector.
-        for(int i = 0; i < data.size(); i++) {
+        for(size_t i = 0; i < data.size(); i++) {
             for(int dim = 0; dim < dimensions; dim++) {
                 coordinates[i][dim] = data[i].coordinates[dim];
             }
@@ -283,7 +295,7 @@ namespace Sequential {
         std::vector<int> ids(data.size(), 0);
         
         // Fill the ids vector.
-        for(int i = 0; i < data.size(); i++) {
+        for(size_t i = 0; i < data.size(); i++) {
             ids[i] = data[i].clusterId;
         }
 
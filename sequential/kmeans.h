@@ -17,15 +17,16 @@ namespace Sequential {
                 * @param K: Number of clusters.
                 * @param dimensions: Number of dimensions.
             */
-            KMeans(const int N, const int K, const int dimensions);
+            KMeans(const long long N, const int K, const int dimensions);
 
             /*
                 * KMeans constructor.
                 * 
                 * @param filePath: Path of the file with the points.
                 * @param K: Number of clusters.
+                * @param weighted: True if the last column of the file is the weight of the points (default: false).
             */
-            KMeans(const std::string& filePath, const int K);
+            KMeans(const std::string& filePath, const int K, const bool weighted = false);
 
 
             /*
@@ -59,13 +60,16 @@ namespace Sequential {
 
         private:
             const std::string filePath = ""; // Path of the file with the points.
-            int N; // Number of points.
+            const bool weighted = false; // True if the last column of the file is the weight of the points.
+            long long N; // Number of points.
             const int K; // Number of clusters.
             int dimensions; // Number of dimensions.
 
             std::vector<Point> points; // Vector of points.
             std::vector<Centroid> centroids; // Vector of centroids.
 
+            double inertia = 0; // Weighted sum of the squared distances of the points to their centroid (of the last iteration).
+
 
             /*
                 * Initializes the points with random coordinates.
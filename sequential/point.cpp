@@ -2,5 +2,5 @@
 
 
 namespace Sequential {
-    Point::Point(const int d, const std::vector<double>& coords, const int pId, const int cId) : dimensions(d), coordinates(coords), pointId(pId), clusterId(cId) { }
+    Point::Point(const int d, const std::vector<double>& coords, const long long pId, const int cId, const double w) : dimensions(d), coordinates(coords), pointId(pId), clusterId(cId), weight(w) { }
 }
\ No newline at end of file
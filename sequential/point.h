@@ -10,8 +10,9 @@ namespace Sequential {
     const int dimensions; // Number of dimensions.
 
     std::vector<double> coordinates; // Vector of coordinates.
-    int pointId; // Identifier of the point.
+    long long pointId; // Identifier of the point.
     int clusterId; // Identifier of the cluster to which the point belongs.
+    double weight; // Weight of the point.
 
 
     /*
@@ -21,8 +22,9 @@ namespace Sequential {
       * @param coordinates: Vector of coordinates.
       * @param pointId: Identifier of the point.
       * @param clusterId: Identifier of the cluster to which the point belongs.
+      * @param weight: Weight of the point (default: 1).
     */
-    Point(const int dimensions, const std::vector<double>& coordinates, const int pointId, const int clusterId);
+    Point(const int dimensions, const std::vector<double>& coordinates, const long long pointId, const int clusterId, const double weight = 1);
   };
 }
 
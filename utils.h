@@ -33,7 +33,7 @@ struct FolderPaths {
     *
     * @return The paths of the folders.
 */
-inline FolderPaths create_folders(const std::string& basePath, std::string executionType, int N, int K, int dimensions, bool log) {
+inline FolderPaths create_folders(const std::string& basePath, std::string executionType, long long N, int K, int dimensions, bool log) {
     // Convert to lowercase the execution type.
     std::transform(executionType.begin(), executionType.end(), executionType.begin(), ::tolower);
     
@@ -120,7 +120,7 @@ inline void log_data(int iteration, const FolderPaths& paths, std::string execut
     * @param K: Number of clusters.
     * @param dimensions: Dimensions of the data.
 */
-inline void plot_data(int iteration, const FolderPaths& paths, std::string executionType, std::string initMode, int N, int K, int dimensions) {
+inline void plot_data(int iteration, const FolderPaths& paths, std::string executionType, std::string initMode, long long N, int K, int dimensions) {
     // Convert to lowercase the execution type string.
     std::transform(executionType.begin(), executionType.end(), executionType.begin(), ::tolower);
 
@@ -262,7 +262,7 @@ inline void convert_gif(int iterations, double executionTimes, const FolderPaths
     * @param K: Number of clusters.
     * @param dimensions: Dimensions of the data.
 */ 
-inline void save_results(int iterations, double executionTimes, const FolderPaths& paths, std::string executionType, int N, int K, int dimensions) {
+inline void save_results(int iterations, double executionTimes, const FolderPaths& paths, std::string executionType, long long N, int K, int dimensions) {
     struct stat buffer;
     std::ofstream outfile;
 